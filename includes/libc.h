@@ -0,0 +1,18 @@
+#define FFI_SCOPE "PHP_RADOS_FFI_LIBC"
+#define FFI_LIB "libc.so.6"
+
+/*
+Subset of libc used for direct file transfers (Linux, 64-bit off_t).
+This file is not generated.
+*/
+
+int open(const char *pathname, int flags, unsigned int mode);
+int close(int fd);
+int ftruncate(int fd, int64_t length);
+int64_t lseek(int fd, int64_t offset, int whence);
+ssize_t pread(int fd, void *buf, size_t count, int64_t offset);
+ssize_t pwrite(int fd, const void *buf, size_t count, int64_t offset);
+void *mmap(void *addr, size_t length, int prot, int flags, int fd, int64_t offset);
+int munmap(void *addr, size_t length);
+int madvise(void *addr, size_t length, int advice);
+int *__errno_location(void);
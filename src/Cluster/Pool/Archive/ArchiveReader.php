@@ -0,0 +1,147 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Archive;
+
+use Aternos\Rados\Exception\ArchiveException;
+use Aternos\Rados\Util\TimeSpec;
+use InvalidArgumentException;
+
+/**
+ * Reads a pool archive written by ArchiveWriter from a stream
+ */
+class ArchiveReader
+{
+    protected bool $headerRead = false;
+    protected bool $finished = false;
+
+    /**
+     * @param resource $stream - readable stream
+     */
+    public function __construct(protected mixed $stream)
+    {
+        if (!is_resource($stream)) {
+            throw new InvalidArgumentException("Stream must be a resource");
+        }
+    }
+
+    /**
+     * Read and validate the archive header
+     *
+     * @return $this
+     * @throws ArchiveException
+     */
+    public function readHeader(): static
+    {
+        $header = $this->read(strlen(ArchiveWriter::MAGIC) + 2);
+        if (!str_starts_with($header, ArchiveWriter::MAGIC)) {
+            throw new ArchiveException("Stream is not a pool archive");
+        }
+        $version = unpack("n", $header, strlen(ArchiveWriter::MAGIC))[1];
+        if ($version !== ArchiveWriter::VERSION) {
+            throw new ArchiveException("Unsupported archive version " . $version);
+        }
+        $this->headerRead = true;
+        return $this;
+    }
+
+    /**
+     * Read the next record
+     *
+     * The last record of an archive is always a Finish record, reading past it is an error.
+     *
+     * @return ArchiveRecord
+     * @throws ArchiveException
+     */
+    public function readRecord(): ArchiveRecord
+    {
+        if (!$this->headerRead) {
+            $this->readHeader();
+        }
+        if ($this->finished) {
+            throw new ArchiveException("Archive has already been read completely");
+        }
+
+        $typeByte = $this->read(1);
+        $type = ArchiveRecordType::tryFrom($typeByte);
+        switch ($type) {
+            case ArchiveRecordType::Object:
+                $objectId = $this->readString();
+                $size = $this->readInt64();
+                $seconds = $this->readInt64();
+                $nanoseconds = $this->readInt32();
+                return new ArchiveRecord($type, $objectId, size: $size, modifiedTime: new TimeSpec($seconds, $nanoseconds));
+            case ArchiveRecordType::XAttribute:
+            case ArchiveRecordType::OMap:
+                $name = $this->readString();
+                return new ArchiveRecord($type, $name, $this->readString());
+            case ArchiveRecordType::Data:
+                $offset = $this->readInt64();
+                return new ArchiveRecord($type, value: $this->readString(), offset: $offset);
+            case ArchiveRecordType::End:
+                return new ArchiveRecord($type);
+            case ArchiveRecordType::Finish:
+                $this->finished = true;
+                return new ArchiveRecord($type, size: $this->readInt64());
+        }
+        throw new ArchiveException("Invalid record type 0x" . bin2hex($typeByte) . " in archive");
+    }
+
+    /**
+     * @return bool
+     */
+    public function isFinished(): bool
+    {
+        return $this->finished;
+    }
+
+    /**
+     * @return string
+     * @throws ArchiveException
+     */
+    protected function readString(): string
+    {
+        $length = $this->readInt32();
+        if ($length === 0) {
+            return "";
+        }
+        return $this->read($length);
+    }
+
+    /**
+     * @return int
+     * @throws ArchiveException
+     */
+    protected function readInt32(): int
+    {
+        return unpack("N", $this->read(4))[1];
+    }
+
+    /**
+     * @return int
+     * @throws ArchiveException
+     */
+    protected function readInt64(): int
+    {
+        return unpack("J", $this->read(8))[1];
+    }
+
+    /**
+     * Read exactly $length bytes, pipes may return less than requested per call
+     *
+     * @param int $length
+     * @return string
+     * @throws ArchiveException
+     */
+    protected function read(int $length): string
+    {
+        $data = "";
+        while (strlen($data) < $length) {
+            $chunk = fread($this->stream, $length - strlen($data));
+            if ($chunk === false || ($chunk === "" && feof($this->stream))) {
+                throw new ArchiveException("Unexpected end of archive");
+            }
+            $data .= $chunk;
+        }
+        return $data;
+    }
+}
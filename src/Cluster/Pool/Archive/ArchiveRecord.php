@@ -0,0 +1,84 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Archive;
+
+use Aternos\Rados\Util\TimeSpec;
+
+/**
+ * Record read from a pool archive
+ *
+ * Which fields are set depends on the record type:
+ * - Object: name (object id), size, modified time
+ * - XAttribute, OMap: name, value
+ * - Data: offset, value
+ * - Finish: size (number of objects in the archive)
+ */
+class ArchiveRecord
+{
+    /**
+     * @param ArchiveRecordType $type
+     * @param string|null $name
+     * @param string|null $value
+     * @param int $offset
+     * @param int $size
+     * @param TimeSpec|null $modifiedTime
+     */
+    public function __construct(
+        protected ArchiveRecordType $type,
+        protected ?string $name = null,
+        protected ?string $value = null,
+        protected int $offset = 0,
+        protected int $size = 0,
+        protected ?TimeSpec $modifiedTime = null
+    )
+    {
+    }
+
+    /**
+     * @return ArchiveRecordType
+     */
+    public function getType(): ArchiveRecordType
+    {
+        return $this->type;
+    }
+
+    /**
+     * @return string|null
+     */
+    public function getName(): ?string
+    {
+        return $this->name;
+    }
+
+    /**
+     * @return string|null
+     */
+    public function getValue(): ?string
+    {
+        return $this->value;
+    }
+
+    /**
+     * @return int
+     */
+    public function getOffset(): int
+    {
+        return $this->offset;
+    }
+
+    /**
+     * @return int
+     */
+    public function getSize(): int
+    {
+        return $this->size;
+    }
+
+    /**
+     * @return TimeSpec|null
+     */
+    public function getModifiedTime(): ?TimeSpec
+    {
+        return $this->modifiedTime;
+    }
+}
@@ -0,0 +1,39 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Archive;
+
+/**
+ * Type byte of a record in a pool archive
+ */
+enum ArchiveRecordType: string
+{
+    /**
+     * Start of an object: id, size and modification time
+     */
+    case Object = "O";
+
+    /**
+     * Extended attribute of the current object
+     */
+    case XAttribute = "X";
+
+    /**
+     * OMap entry of the current object
+     */
+    case OMap = "M";
+
+    /**
+     * Chunk of data of the current object at an offset
+     */
+    case Data = "D";
+
+    /**
+     * End of the current object
+     */
+    case End = "E";
+
+    /**
+     * End of the archive, contains the number of objects
+     */
+    case Finish = "Z";
+}
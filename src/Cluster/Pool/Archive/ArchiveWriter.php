@@ -0,0 +1,196 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Archive;
+
+use Aternos\Rados\Exception\ArchiveException;
+use Aternos\Rados\Util\TimeSpec;
+use InvalidArgumentException;
+
+/**
+ * Writes a pool archive to a stream
+ *
+ * The archive is strictly sequential, so it can be written to pipes and sockets.
+ * It starts with a header (magic and version) followed by records. Each record
+ * starts with a type byte (see ArchiveRecordType), strings are prefixed with their
+ * length as 32-bit big-endian integer, offsets and sizes are 64-bit big-endian integers.
+ */
+class ArchiveWriter
+{
+    const MAGIC = "RADOSARC";
+    const VERSION = 1;
+
+    protected int $objectCount = 0;
+    protected int $bytesWritten = 0;
+    protected bool $inObject = false;
+
+    /**
+     * @param resource $stream - writable stream
+     */
+    public function __construct(protected mixed $stream)
+    {
+        if (!is_resource($stream)) {
+            throw new InvalidArgumentException("Stream must be a resource");
+        }
+    }
+
+    /**
+     * Write the archive header
+     *
+     * @return $this
+     * @throws ArchiveException
+     */
+    public function writeHeader(): static
+    {
+        return $this->write(static::MAGIC . pack("n", static::VERSION));
+    }
+
+    /**
+     * Start a new object
+     *
+     * @param string $objectId
+     * @param int $size
+     * @param TimeSpec $modifiedTime
+     * @return $this
+     * @throws ArchiveException
+     */
+    public function beginObject(string $objectId, int $size, TimeSpec $modifiedTime): static
+    {
+        if ($this->inObject) {
+            throw new ArchiveException("Previous object has not been ended");
+        }
+        $this->inObject = true;
+        return $this->write(ArchiveRecordType::Object->value . $this->encodeString($objectId)
+            . pack("J", $size) . pack("J", $modifiedTime->getSeconds()) . pack("N", $modifiedTime->getNanoseconds()));
+    }
+
+    /**
+     * Write an extended attribute of the current object
+     *
+     * @param string $name
+     * @param string $value
+     * @return $this
+     * @throws ArchiveException
+     */
+    public function writeXAttribute(string $name, string $value): static
+    {
+        return $this->writeObjectRecord(ArchiveRecordType::XAttribute->value . $this->encodeString($name) . $this->encodeString($value));
+    }
+
+    /**
+     * Write an omap entry of the current object
+     *
+     * @param string $key
+     * @param string $value
+     * @return $this
+     * @throws ArchiveException
+     */
+    public function writeOMapEntry(string $key, string $value): static
+    {
+        return $this->writeObjectRecord(ArchiveRecordType::OMap->value . $this->encodeString($key) . $this->encodeString($value));
+    }
+
+    /**
+     * Write a chunk of data of the current object
+     *
+     * @param int $offset
+     * @param string $data
+     * @return $this
+     * @throws ArchiveException
+     */
+    public function writeData(int $offset, string $data): static
+    {
+        return $this->writeObjectRecord(ArchiveRecordType::Data->value . pack("J", $offset) . $this->encodeString($data));
+    }
+
+    /**
+     * End the current object
+     *
+     * @return $this
+     * @throws ArchiveException
+     */
+    public function endObject(): static
+    {
+        $this->writeObjectRecord(ArchiveRecordType::End->value);
+        $this->inObject = false;
+        $this->objectCount++;
+        return $this;
+    }
+
+    /**
+     * Write the end of the archive and flush the stream
+     *
+     * @return $this
+     * @throws ArchiveException
+     */
+    public function finish(): static
+    {
+        if ($this->inObject) {
+            throw new ArchiveException("Last object has not been ended");
+        }
+        $this->write(ArchiveRecordType::Finish->value . pack("J", $this->objectCount));
+        fflush($this->stream);
+        return $this;
+    }
+
+    /**
+     * Get the number of completely written objects
+     *
+     * @return int
+     */
+    public function getObjectCount(): int
+    {
+        return $this->objectCount;
+    }
+
+    /**
+     * Get the number of bytes written to the stream
+     *
+     * @return int
+     */
+    public function getBytesWritten(): int
+    {
+        return $this->bytesWritten;
+    }
+
+    /**
+     * @param string $value
+     * @return string
+     */
+    protected function encodeString(string $value): string
+    {
+        return pack("N", strlen($value)) . $value;
+    }
+
+    /**
+     * @param string $data
+     * @return $this
+     * @throws ArchiveException
+     */
+    protected function writeObjectRecord(string $data): static
+    {
+        if (!$this->inObject) {
+            throw new ArchiveException("No object has been started");
+        }
+        return $this->write($data);
+    }
+
+    /**
+     * @param string $data
+     * @return $this
+     * @throws ArchiveException
+     */
+    protected function write(string $data): static
+    {
+        $length = strlen($data);
+        $written = 0;
+        while ($written < $length) {
+            $result = fwrite($this->stream, $written === 0 ? $data : substr($data, $written));
+            if ($result === false || $result === 0) {
+                throw new ArchiveException("Failed to write to archive stream");
+            }
+            $written += $result;
+        }
+        $this->bytesWritten += $length;
+        return $this;
+    }
+}
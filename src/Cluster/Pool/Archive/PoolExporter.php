@@ -0,0 +1,241 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Archive;
+
+use Aternos\Rados\Cluster\Pool\IOContext;
+use Aternos\Rados\Cluster\Pool\Object\RadosObject;
+use Aternos\Rados\Cluster\Pool\Snapshot\SnapshotInterface;
+use Aternos\Rados\Completion\OperationCompletion;
+use Aternos\Rados\Completion\ReadCompletion;
+use Aternos\Rados\Exception\ArchiveException;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Generated\Errno;
+use Aternos\Rados\Operation\Read\ReadOperation;
+use Aternos\Rados\Operation\Read\Task\GetXAttributesTask;
+use Aternos\Rados\Operation\Read\Task\OMapGetTask;
+use Aternos\Rados\Operation\Read\Task\ReadTask;
+use Aternos\Rados\Operation\Read\Task\StatTask;
+use InvalidArgumentException;
+use Throwable;
+
+/**
+ * Exports all objects of the current namespace of an io context into an archive
+ *
+ * The export reads from a pool snapshot, so the archive is a consistent point-in-time
+ * copy of the pool, even if objects are modified while the export is running.
+ * Objects are read with up to $concurrency async read operations in flight and written
+ * to the archive in listing order. Memory usage is bounded by roughly
+ * ($concurrency + READ_AHEAD) * $chunkSize plus one omap batch per object in flight,
+ * independent of the size of the pool or of single objects.
+ *
+ * Pool snapshots cannot be used on pools with self-managed snapshots (e.g. RBD pools).
+ */
+class PoolExporter
+{
+    const DEFAULT_CONCURRENCY = 16;
+    const DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;
+    const DEFAULT_OMAP_BATCH_SIZE = 1024;
+    const READ_AHEAD = 4;
+    const SNAPSHOT_PREFIX = "export.";
+
+    /**
+     * @param IOContext $ioContext - io context to export, the read snapshot of this io context is changed during the export
+     * @param int $concurrency - maximum number of objects read in parallel
+     * @param int $chunkSize - maximum size of a data chunk read in one operation
+     * @param int $omapBatchSize - maximum number of omap entries read in one operation
+     */
+    public function __construct(
+        protected IOContext $ioContext,
+        protected int $concurrency = self::DEFAULT_CONCURRENCY,
+        protected int $chunkSize = self::DEFAULT_CHUNK_SIZE,
+        protected int $omapBatchSize = self::DEFAULT_OMAP_BATCH_SIZE
+    )
+    {
+        if ($concurrency < 1 || $chunkSize < 1 || $omapBatchSize < 1) {
+            throw new InvalidArgumentException("Concurrency, chunk size and omap batch size must be positive");
+        }
+    }
+
+    /**
+     * Export the pool to a stream
+     *
+     * If no snapshot is passed, a temporary pool snapshot is created and removed after the export.
+     * If the export fails, errors while removing the temporary snapshot are ignored, so the original error is thrown.
+     * The read snapshot of the io context is reset to the head after the export.
+     *
+     * @param resource $stream - writable stream, e.g. a file or STDOUT
+     * @param SnapshotInterface|null $snapshot - existing snapshot to export
+     * @return int - number of exported objects
+     * @throws RadosException
+     */
+    public function export(mixed $stream, ?SnapshotInterface $snapshot = null): int
+    {
+        $writer = new ArchiveWriter($stream);
+        $temporary = $snapshot === null;
+        $snapshot ??= $this->ioContext->createSnapshot(static::SNAPSHOT_PREFIX . bin2hex(random_bytes(8)));
+
+        $pending = [];
+        $failure = null;
+        try {
+            $this->ioContext->setReadSnapshot($snapshot);
+            $writer->writeHeader();
+
+            foreach ($this->ioContext->createObjectIterator() as $entry) {
+                $pending[] = $this->readObjectAsync($entry->getObject());
+                if (count($pending) >= $this->concurrency) {
+                    $this->writeObject($writer, array_shift($pending));
+                }
+            }
+            while (count($pending) > 0) {
+                $this->writeObject($writer, array_shift($pending));
+            }
+
+            $writer->finish();
+        } catch (Throwable $e) {
+            $failure = $e;
+            throw $e;
+        } finally {
+            // The tasks of pending reads own the buffers librados reads into
+            foreach ($pending as [, , , , , $completion]) {
+                $completion->waitForComplete();
+            }
+            $this->ioContext->setReadSnapshot(null);
+            if ($temporary) {
+                try {
+                    $snapshot->remove();
+                } catch (RadosException $e) {
+                    if ($failure === null) {
+                        throw $e;
+                    }
+                }
+            }
+        }
+        return $writer->getObjectCount();
+    }
+
+    /**
+     * Start reading stat, xattrs, the first omap batch and the first data chunk of an object
+     *
+     * @param RadosObject $object
+     * @return array{RadosObject, StatTask, GetXAttributesTask, OMapGetTask, ReadTask, OperationCompletion}
+     * @throws RadosException
+     */
+    protected function readObjectAsync(RadosObject $object): array
+    {
+        $stat = new StatTask();
+        $xAttributes = new GetXAttributesTask();
+        $omap = new OMapGetTask($this->omapBatchSize);
+        $read = new ReadTask($this->chunkSize, 0);
+
+        $completion = ReadOperation::create($this->ioContext->getFFI())
+            ->addTask($stat)
+            ->addTask($xAttributes)
+            ->addTask($omap)
+            ->addTask($read)
+            ->operateAsync($object);
+        return [$object, $stat, $xAttributes, $omap, $read, $completion];
+    }
+
+    /**
+     * Wait for a pending object read and write the object to the archive
+     *
+     * @param ArchiveWriter $writer
+     * @param array{RadosObject, StatTask, GetXAttributesTask, OMapGetTask, ReadTask, OperationCompletion} $pending
+     * @return bool - false if the object does not exist in the snapshot
+     * @throws RadosException
+     */
+    protected function writeObject(ArchiveWriter $writer, array $pending): bool
+    {
+        [$object, $statTask, $xAttributesTask, $omapTask, $readTask, $completion] = $pending;
+        try {
+            $completion->waitAndGetResult();
+        } catch (RadosException $e) {
+            if ($e->is(Errno::ENOENT)) {
+                return false;
+            }
+            throw $e;
+        }
+
+        $stat = $statTask->getResult();
+        $writer->beginObject($object->getId(), $stat->getSize(), $stat->getModifiedTime());
+
+        foreach ($xAttributesTask->getResult() as $name => $value) {
+            $writer->writeXAttribute($name, $value);
+        }
+        $this->writeOMap($writer, $object, $omapTask);
+
+        $data = $readTask->getResult();
+        if ($data !== "") {
+            $writer->writeData(0, $data);
+        }
+        $this->writeRemainingData($writer, $object, strlen($data), $stat->getSize());
+
+        $writer->endObject();
+        return true;
+    }
+
+    /**
+     * Write the first omap batch and read and write all remaining batches
+     *
+     * @param ArchiveWriter $writer
+     * @param RadosObject $object
+     * @param OMapGetTask $task
+     * @return void
+     * @throws RadosException
+     */
+    protected function writeOMap(ArchiveWriter $writer, RadosObject $object, OMapGetTask $task): void
+    {
+        while (true) {
+            $result = $task->getResult();
+            $last = null;
+            foreach ($result->getIterator() as $key => $value) {
+                $writer->writeOMapEntry($key, $value ?? "");
+                $last = $key;
+            }
+            if (!$result->hasMore() || $last === null) {
+                return;
+            }
+
+            $task = new OMapGetTask($this->omapBatchSize, $last);
+            ReadOperation::create($this->ioContext->getFFI())->addTask($task)->operate($object);
+        }
+    }
+
+    /**
+     * Read the data after the first chunk with up to READ_AHEAD async reads in flight
+     *
+     * @param ArchiveWriter $writer
+     * @param RadosObject $object
+     * @param int $offset - offset of the first byte that has not been written yet
+     * @param int $size - size of the object in the snapshot
+     * @return void
+     * @throws RadosException
+     */
+    protected function writeRemainingData(ArchiveWriter $writer, RadosObject $object, int $offset, int $size): void
+    {
+        /** @var array{int, ReadCompletion}[] $reads */
+        $reads = [];
+        $next = $offset;
+        try {
+            while ($offset < $size) {
+                while (count($reads) < static::READ_AHEAD && $next < $size) {
+                    $length = min($this->chunkSize, $size - $next);
+                    $reads[] = [$next, $object->readAsync($length, $next)];
+                    $next += $length;
+                }
+
+                [$chunkOffset, $completion] = array_shift($reads);
+                $chunk = $completion->waitAndGetResult();
+                if ($chunk === "") {
+                    throw new ArchiveException("Object " . $object->getId() . " is shorter than its size in the snapshot");
+                }
+                $writer->writeData($chunkOffset, $chunk);
+                $offset = $chunkOffset + strlen($chunk);
+            }
+        } finally {
+            foreach ($reads as [, $completion]) {
+                $completion->waitForComplete();
+            }
+        }
+    }
+}
@@ -0,0 +1,234 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Archive;
+
+use Aternos\Rados\Cluster\Pool\IOContext;
+use Aternos\Rados\Cluster\Pool\Object\RadosObject;
+use Aternos\Rados\Completion\OperationCompletion;
+use Aternos\Rados\Constants\CreateMode;
+use Aternos\Rados\Exception\ArchiveException;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Generated\Errno;
+use Aternos\Rados\Operation\Write\Task\CreateObjectTask;
+use Aternos\Rados\Operation\Write\Task\OMapSetTask;
+use Aternos\Rados\Operation\Write\Task\RemoveTask;
+use Aternos\Rados\Operation\Write\Task\SetXAttributeTask;
+use Aternos\Rados\Operation\Write\Task\WriteTask;
+use Aternos\Rados\Operation\Write\WriteOperation;
+use Aternos\Rados\Util\TimeSpec;
+use InvalidArgumentException;
+
+/**
+ * Restores objects from an archive written by PoolExporter into the current namespace of an io context
+ *
+ * The records of each object are collected into write operations of up to $chunkSize bytes,
+ * which are submitted as async operations with up to $concurrency operations in flight.
+ * Operations on the same object are applied by the OSDs in the order they were submitted,
+ * so an object can be restored by several pipelined operations.
+ * Existing objects with the same id are replaced, objects that are not in the archive are not touched.
+ */
+class PoolImporter
+{
+    const DEFAULT_CONCURRENCY = 16;
+    const DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;
+
+    /**
+     * @var array{OperationCompletion, bool}[]
+     */
+    protected array $inFlight = [];
+
+    protected ?RadosObject $object = null;
+    protected ?WriteOperation $operation = null;
+    protected ?TimeSpec $modifiedTime = null;
+    protected array $omapValues = [];
+    protected int $operationSize = 0;
+
+    /**
+     * @param IOContext $ioContext - io context to import into
+     * @param int $concurrency - maximum number of write operations in flight
+     * @param int $chunkSize - size in bytes after which a write operation is submitted
+     */
+    public function __construct(
+        protected IOContext $ioContext,
+        protected int $concurrency = self::DEFAULT_CONCURRENCY,
+        protected int $chunkSize = self::DEFAULT_CHUNK_SIZE
+    )
+    {
+        if ($concurrency < 1 || $chunkSize < 1) {
+            throw new InvalidArgumentException("Concurrency and chunk size must be positive");
+        }
+    }
+
+    /**
+     * Import all objects from a stream
+     *
+     * @param resource $stream - readable stream, e.g. a file or STDIN
+     * @return int - number of imported objects
+     * @throws RadosException
+     */
+    public function import(mixed $stream): int
+    {
+        $reader = new ArchiveReader($stream);
+        $reader->readHeader();
+        $count = 0;
+
+        try {
+            while (true) {
+                $record = $reader->readRecord();
+                switch ($record->getType()) {
+                    case ArchiveRecordType::Object:
+                        $this->beginObject($record);
+                        break;
+                    case ArchiveRecordType::XAttribute:
+                        $this->getOperation()->addTask(new SetXAttributeTask($record->getName(), $record->getValue()));
+                        $this->addSize(strlen($record->getName()) + strlen($record->getValue()));
+                        break;
+                    case ArchiveRecordType::OMap:
+                        $this->getOperation();
+                        $this->omapValues[$record->getName()] = $record->getValue();
+                        $this->addSize(strlen($record->getName()) + strlen($record->getValue()));
+                        break;
+                    case ArchiveRecordType::Data:
+                        $this->getOperation()->addTask(new WriteTask($record->getValue(), $record->getOffset()));
+                        $this->addSize(strlen($record->getValue()));
+                        break;
+                    case ArchiveRecordType::End:
+                        $this->getOperation();
+                        $this->submit();
+                        $this->object = null;
+                        $count++;
+                        break;
+                    case ArchiveRecordType::Finish:
+                        if ($this->object !== null) {
+                            throw new ArchiveException("Archive ended inside of object " . $this->object->getId());
+                        }
+                        if ($record->getSize() !== $count) {
+                            throw new ArchiveException("Archive contains " . $count . " objects, expected " . $record->getSize());
+                        }
+                        $this->waitAll();
+                        return $count;
+                }
+            }
+        } finally {
+            $this->reset();
+        }
+    }
+
+    /**
+     * Start restoring an object, existing data, xattrs and omap entries of the object are removed
+     *
+     * @param ArchiveRecord $record
+     * @return void
+     * @throws RadosException
+     */
+    protected function beginObject(ArchiveRecord $record): void
+    {
+        if ($this->object !== null) {
+            throw new ArchiveException("Object " . $this->object->getId() . " has not been ended");
+        }
+        $this->object = $this->ioContext->getObject($record->getName());
+        $this->modifiedTime = $record->getModifiedTime();
+
+        $this->operation = WriteOperation::create($this->ioContext->getFFI())->addTask(new RemoveTask());
+        $this->submit(true);
+
+        $this->getOperation()->addTask(new CreateObjectTask(CreateMode::Idempotent));
+    }
+
+    /**
+     * Get the write operation for the current object, creating it if necessary
+     *
+     * @return WriteOperation
+     * @throws ArchiveException
+     */
+    protected function getOperation(): WriteOperation
+    {
+        if ($this->object === null) {
+            throw new ArchiveException("Object record expected");
+        }
+        return $this->operation ??= WriteOperation::create($this->ioContext->getFFI());
+    }
+
+    /**
+     * @param int $size
+     * @return void
+     * @throws RadosException
+     */
+    protected function addSize(int $size): void
+    {
+        $this->operationSize += $size;
+        if ($this->operationSize >= $this->chunkSize) {
+            $this->submit();
+        }
+    }
+
+    /**
+     * Submit the current write operation, waiting for the oldest operation if too many are in flight
+     *
+     * @param bool $ignoreMissing - ignore ENOENT errors of this operation
+     * @return void
+     * @throws RadosException
+     */
+    protected function submit(bool $ignoreMissing = false): void
+    {
+        if ($this->operation !== null && count($this->omapValues) > 0) {
+            $this->operation->addTask(new OMapSetTask($this->omapValues));
+        }
+        if ($this->operation !== null && count($this->operation->getTasks()) > 0) {
+            while (count($this->inFlight) >= $this->concurrency) {
+                $this->wait(array_shift($this->inFlight));
+            }
+            $completion = $this->operation->operateAsync($this->object, $this->modifiedTime);
+            $this->inFlight[] = [$completion, $ignoreMissing];
+        }
+        $this->operation = null;
+        $this->omapValues = [];
+        $this->operationSize = 0;
+    }
+
+    /**
+     * @return void
+     * @throws RadosException
+     */
+    protected function waitAll(): void
+    {
+        while (count($this->inFlight) > 0) {
+            $this->wait(array_shift($this->inFlight));
+        }
+    }
+
+    /**
+     * @param array{OperationCompletion, bool} $pending
+     * @return void
+     * @throws RadosException
+     */
+    protected function wait(array $pending): void
+    {
+        [$completion, $ignoreMissing] = $pending;
+        try {
+            $completion->waitAndGetResult();
+        } catch (RadosException $e) {
+            if (!$ignoreMissing || !$e->is(Errno::ENOENT)) {
+                throw $e;
+            }
+        }
+    }
+
+    /**
+     * Drop the state of an aborted import, operations still in flight are waited for
+     *
+     * @return void
+     */
+    protected function reset(): void
+    {
+        foreach ($this->inFlight as [$completion]) {
+            $completion->waitForComplete();
+        }
+        $this->inFlight = [];
+        $this->object = null;
+        $this->operation = null;
+        $this->modifiedTime = null;
+        $this->omapValues = [];
+        $this->operationSize = 0;
+    }
+}
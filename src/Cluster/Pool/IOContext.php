@@ -4,6 +4,7 @@ namespace Aternos\Rados\Cluster\Pool;
 
 use Aternos\Rados\Cluster\Cluster;
 use Aternos\Rados\Cluster\ClusterConfig;
+use Aternos\Rados\Cluster\Pool\Latency\LatencyPolicy;
 use Aternos\Rados\Cluster\Pool\Object\RadosObject;
 use Aternos\Rados\Cluster\Pool\ObjectIterator\ObjectCursor;
 use Aternos\Rados\Cluster\Pool\ObjectIterator\ObjectIterator;
@@ -11,6 +12,9 @@ use Aternos\Rados\Cluster\Pool\ObjectIterator\ObjectRange;
 use Aternos\Rados\Cluster\Pool\Snapshot\SelfManagedSnapshot;
 use Aternos\Rados\Cluster\Pool\Snapshot\Snapshot;
 use Aternos\Rados\Cluster\Pool\Snapshot\SnapshotInterface;
+use Aternos\Rados\Cluster\Pool\Throttle\Throttle;
+use Aternos\Rados\Cluster\Pool\Throttle\ThrottlePriority;
+use Aternos\Rados\Completion\Completion;
 use Aternos\Rados\Completion\FlushCompletion;
 use Aternos\Rados\Completion\SelfManagedSnapshotCreateCompletion;
 use Aternos\Rados\Constants\Constants;
@@ -26,6 +30,10 @@ use FFI\CData;
 
 class IOContext extends WrappedType
 {
+    protected ?LatencyPolicy $latencyPolicy = null;
+    protected ?Throttle $throttle = null;
+    protected ThrottlePriority $throttlePriority = ThrottlePriority::Normal;
+
     /**
      * @param Cluster $cluster
      * @param CData $data
@@ -91,6 +99,100 @@ class IOContext extends WrappedType
         return $this->cluster;
     }
 
+    /**
+     * Get the deadline and hedging policy used for operations on this io context
+     *
+     * @return LatencyPolicy|null
+     */
+    public function getLatencyPolicy(): ?LatencyPolicy
+    {
+        return $this->latencyPolicy;
+    }
+
+    /**
+     * Set the deadline and hedging policy used for operations on this io context
+     *
+     * @param LatencyPolicy|null $latencyPolicy - null to wait indefinitely and disable hedging
+     * @return $this
+     */
+    public function setLatencyPolicy(?LatencyPolicy $latencyPolicy): static
+    {
+        $this->latencyPolicy = $latencyPolicy;
+        return $this;
+    }
+
+    /**
+     * Get the throttle applied to async operations on this io context
+     *
+     * @return Throttle|null
+     */
+    public function getThrottle(): ?Throttle
+    {
+        return $this->throttle;
+    }
+
+    /**
+     * @return ThrottlePriority
+     */
+    public function getThrottlePriority(): ThrottlePriority
+    {
+        return $this->throttlePriority;
+    }
+
+    /**
+     * Set the throttle applied to async operations on this io context
+     * A throttle can be shared between multiple io contexts with different priorities.
+     *
+     * @param Throttle|null $throttle - null to disable throttling
+     * @param ThrottlePriority $priority - priority of operations from this io context
+     * @return $this
+     */
+    public function setThrottle(?Throttle $throttle, ThrottlePriority $priority = ThrottlePriority::Normal): static
+    {
+        $this->throttle = $throttle;
+        $this->throttlePriority = $priority;
+        return $this;
+    }
+
+    /**
+     * Block until the throttle admits a new async operation
+     *
+     * @param int $bytes - payload size of the operation
+     * @return void
+     * @throws RadosException
+     * @internal Called by async operations before submitting them
+     */
+    public function acquireThrottle(int $bytes = 0): void
+    {
+        $this->throttle?->acquire($bytes, $this->throttlePriority);
+    }
+
+    /**
+     * Track a submitted async operation for the in-flight limit of the throttle
+     *
+     * @template T of Completion
+     * @param T $completion
+     * @return T
+     * @internal Called by async operations after submitting them
+     */
+    public function trackThrottled(Completion $completion): Completion
+    {
+        $this->throttle?->track($completion, $this->throttlePriority);
+        return $completion;
+    }
+
+    /**
+     * Give back the throttle capacity of an admitted async operation that could not be submitted
+     *
+     * @param int $bytes - payload size the operation was admitted with
+     * @return void
+     * @internal Called by async operations if submitting them failed
+     */
+    public function releaseThrottle(int $bytes = 0): void
+    {
+        $this->throttle?->release($bytes, $this->throttlePriority);
+    }
+
     /**
      * Binding for rados_ioctx_pool_stat
      * Get pool usage statistics
@@ -0,0 +1,406 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Latency;
+
+use Aternos\Rados\Completion\Completion;
+use Aternos\Rados\Completion\ResultCompletion;
+use Aternos\Rados\Constants\OperationFlag;
+use Aternos\Rados\Exception\CompletionTimeoutException;
+use Aternos\Rados\Exception\RadosException;
+use Closure;
+use InvalidArgumentException;
+
+/**
+ * Deadline and hedging configuration for an IOContext
+ *
+ * If a timeout is set, it is used as deadline by Operation::operateWithTimeout and by hedged reads,
+ * the operation is cancelled once it expires. Other waits on completions are not limited by the policy.
+ * If a hedge delay is set, hedged reads are reissued with the hedge flags (e.g. to allow reading from a replica)
+ * after the delay has passed. The first result wins. A losing hedged read
+ * is cancelled, a losing first attempt keeps running until it completes to record its latency.
+ */
+class LatencyPolicy
+{
+    const MAX_PENDING_PRIMARIES = 64;
+
+    /**
+     * Maximum time in seconds between the last check of a losing first attempt and the check that
+     * found it complete for its latency to be recorded
+     */
+    const PRIMARY_LATENCY_RESOLUTION = 0.002;
+
+    protected LatencyStats $primaryLatencies;
+    protected LatencyStats $effectiveLatencies;
+    protected int $hedgeCount = 0;
+    protected int $hedgeWinCount = 0;
+    protected int $timeoutCount = 0;
+    protected int $unmeasuredPrimaryCount = 0;
+    protected int $abandonedPrimaryCount = 0;
+
+    /**
+     * @var array{int, ResultCompletion, ?Closure, int}[] - first attempts that lost against a hedged read:
+     * start time, completion, discard callback, time of the last check that found it incomplete
+     */
+    protected array $pendingPrimaries = [];
+
+    /**
+     * @param float|null $timeout - deadline in seconds, null to wait indefinitely
+     * @param float|null $hedgeDelay - delay in seconds before a hedged read is issued, null to disable hedging
+     * @param OperationFlag[] $hedgeFlags - operation flags for hedged reads
+     * @param int $sampleCapacity - number of latency samples to keep for percentiles
+     */
+    public function __construct(
+        protected ?float $timeout = null,
+        protected ?float $hedgeDelay = null,
+        protected array $hedgeFlags = [OperationFlag::BalanceReads],
+        int $sampleCapacity = 1024
+    )
+    {
+        if ($this->timeout !== null && $this->timeout <= 0) {
+            throw new InvalidArgumentException("Timeout must be greater than 0");
+        }
+        if ($this->hedgeDelay !== null && $this->hedgeDelay < 0) {
+            throw new InvalidArgumentException("Hedge delay must not be negative");
+        }
+        $this->primaryLatencies = new LatencyStats($sampleCapacity);
+        $this->effectiveLatencies = new LatencyStats($sampleCapacity);
+    }
+
+    /**
+     * @return float|null
+     */
+    public function getTimeout(): ?float
+    {
+        return $this->timeout;
+    }
+
+    /**
+     * @param float|null $timeout - deadline in seconds, null to wait indefinitely
+     * @return $this
+     */
+    public function setTimeout(?float $timeout): static
+    {
+        if ($timeout !== null && $timeout <= 0) {
+            throw new InvalidArgumentException("Timeout must be greater than 0");
+        }
+        $this->timeout = $timeout;
+        return $this;
+    }
+
+    /**
+     * @return float|null
+     */
+    public function getHedgeDelay(): ?float
+    {
+        return $this->hedgeDelay;
+    }
+
+    /**
+     * @param float|null $hedgeDelay - delay in seconds before a hedged read is issued, null to disable hedging
+     * @return $this
+     */
+    public function setHedgeDelay(?float $hedgeDelay): static
+    {
+        if ($hedgeDelay !== null && $hedgeDelay < 0) {
+            throw new InvalidArgumentException("Hedge delay must not be negative");
+        }
+        $this->hedgeDelay = $hedgeDelay;
+        return $this;
+    }
+
+    /**
+     * @return OperationFlag[]
+     */
+    public function getHedgeFlags(): array
+    {
+        return $this->hedgeFlags;
+    }
+
+    /**
+     * @param OperationFlag[] $hedgeFlags
+     * @return $this
+     */
+    public function setHedgeFlags(array $hedgeFlags): static
+    {
+        $this->hedgeFlags = $hedgeFlags;
+        return $this;
+    }
+
+    /**
+     * Latencies of the first attempts of reads, i.e. the latencies reads would have without hedging
+     *
+     * First attempts that lost against a hedged read keep running in the background. They are checked
+     * by later hedged reads, by this method and by waitForPendingPrimaries(). Their latency is only recorded
+     * if the completion was noticed within PRIMARY_LATENCY_RESOLUTION of the previous check, otherwise
+     * it is counted by getUnmeasuredPrimaryCount(). First attempts that are still running after the timeout,
+     * or when more than MAX_PENDING_PRIMARIES are running, are cancelled and counted by getAbandonedPrimaryCount().
+     *
+     * @note Slow first attempts are the ones that lose against hedged reads, so they are more likely to be
+     * unmeasured or abandoned than fast ones. The percentiles underestimate the latency without hedging
+     * if these counts are high compared to the number of samples.
+     *
+     * @return LatencyStats
+     */
+    public function getPrimaryLatencies(): LatencyStats
+    {
+        $this->collectPendingPrimaries();
+        return $this->primaryLatencies;
+    }
+
+    /**
+     * Latencies of all successful reads, including hedged ones
+     *
+     * @return LatencyStats
+     */
+    public function getEffectiveLatencies(): LatencyStats
+    {
+        return $this->effectiveLatencies;
+    }
+
+    /**
+     * @return int
+     */
+    public function getHedgeCount(): int
+    {
+        return $this->hedgeCount;
+    }
+
+    /**
+     * @return int
+     */
+    public function getHedgeWinCount(): int
+    {
+        return $this->hedgeWinCount;
+    }
+
+    /**
+     * @return int
+     */
+    public function getTimeoutCount(): int
+    {
+        return $this->timeoutCount;
+    }
+
+    /**
+     * Number of losing first attempts that completed, but were noticed too late to record their latency
+     *
+     * @return int
+     */
+    public function getUnmeasuredPrimaryCount(): int
+    {
+        return $this->unmeasuredPrimaryCount;
+    }
+
+    /**
+     * Number of losing first attempts that were cancelled because of the timeout or the pending limit
+     *
+     * @return int
+     */
+    public function getAbandonedPrimaryCount(): int
+    {
+        return $this->abandonedPrimaryCount;
+    }
+
+    /**
+     * Wait for all first attempts that lost against a hedged read and record their latencies
+     *
+     * If a timeout is set, first attempts that are still running after it are cancelled.
+     *
+     * @return $this
+     * @throws RadosException
+     */
+    public function waitForPendingPrimaries(): static
+    {
+        $pending = $this->pendingPrimaries;
+        $this->pendingPrimaries = [];
+        foreach ($pending as [$start, $completion, $discard, $lastSeen]) {
+            if ($completion->isComplete()) {
+                $this->recordPrimary($start, $lastSeen, hrtime(true));
+            } else {
+                $remaining = $this->timeout === null ? null : ($start - hrtime(true)) / 1e9 + $this->timeout;
+                if ($remaining === null) {
+                    $completion->waitForComplete();
+                } else if (!$completion->waitForCompleteWithTimeout(max(0, $remaining))) {
+                    $this->abandonedPrimaryCount++;
+                    $this->abandon($completion, $discard);
+                    continue;
+                }
+                $this->primaryLatencies->record((hrtime(true) - $start) / 1e9);
+            }
+            if ($discard !== null) {
+                $discard($completion);
+            }
+        }
+        return $this;
+    }
+
+    /**
+     * Reset all statistics
+     *
+     * @return $this
+     */
+    public function resetStats(): static
+    {
+        $this->primaryLatencies->reset();
+        $this->effectiveLatencies->reset();
+        $this->hedgeCount = 0;
+        $this->hedgeWinCount = 0;
+        $this->timeoutCount = 0;
+        $this->unmeasuredPrimaryCount = 0;
+        $this->abandonedPrimaryCount = 0;
+        return $this;
+    }
+
+    /**
+     * Record a timeout, e.g. from a completion that was waited for with this policy
+     *
+     * @return $this
+     * @internal
+     */
+    public function recordTimeout(): static
+    {
+        $this->timeoutCount++;
+        return $this;
+    }
+
+    /**
+     * Submit a read and, if configured, a hedged read and wait for the first one to complete
+     *
+     * @template T of ResultCompletion
+     * @param Closure(OperationFlag[]): T $submit - submits a read with additional operation flags
+     * @param Closure(T): void|null $discard - called with the completion that lost or timed out once it is no longer used
+     * @return T - the completion that completed first
+     * @throws RadosException
+     * @internal Use RadosObject::readHedged or PreparedReadOperation::operateHedged instead
+     */
+    public function executeHedged(Closure $submit, ?Closure $discard = null): ResultCompletion
+    {
+        $start = hrtime(true);
+        $deadline = $this->timeout === null ? null : $start + (int)($this->timeout * 1e9);
+        $hedgeAt = $this->hedgeDelay === null ? null : $start + (int)($this->hedgeDelay * 1e9);
+
+        $this->collectPendingPrimaries();
+        $primary = $submit([]);
+        $hedge = null;
+        $interval = Completion::POLL_MIN_INTERVAL;
+        while (true) {
+            $checked = hrtime(true);
+            if ($primary->isComplete()) {
+                $winner = $primary;
+                $loser = $hedge;
+                break;
+            }
+            if ($hedge !== null && $hedge->isComplete()) {
+                $winner = $hedge;
+                $loser = $primary;
+                break;
+            }
+
+            $now = hrtime(true);
+            if ($deadline !== null && $now >= $deadline) {
+                $this->timeoutCount++;
+                $this->abandon($primary, $discard);
+                if ($hedge !== null) {
+                    $this->abandon($hedge, $discard);
+                }
+                throw CompletionTimeoutException::create();
+            }
+
+            if ($hedge === null && $hedgeAt !== null && $now >= $hedgeAt) {
+                $hedge = $submit($this->hedgeFlags);
+                $this->hedgeCount++;
+                $interval = Completion::POLL_MIN_INTERVAL;
+                continue;
+            }
+
+            $next = $deadline ?? PHP_INT_MAX;
+            if ($hedge === null && $hedgeAt !== null) {
+                $next = min($next, $hedgeAt);
+            }
+            usleep((int)max(1, min($interval, ($next - $now) / 1000)));
+            $this->collectPendingPrimaries();
+            $interval = min($interval * 2, Completion::POLL_MAX_INTERVAL);
+        }
+
+        $latency = (hrtime(true) - $start) / 1e9;
+        $this->effectiveLatencies->record($latency);
+        if ($winner === $primary) {
+            $this->primaryLatencies->record($latency);
+            if ($loser !== null) {
+                $this->abandon($loser, $discard);
+            }
+        } else {
+            $this->hedgeWinCount++;
+            $this->pendingPrimaries[] = [$start, $primary, $discard, $checked];
+            $this->collectPendingPrimaries();
+        }
+        return $winner;
+    }
+
+    /**
+     * Record the latencies of first attempts that lost against a hedged read and have completed since the last check
+     *
+     * @return void
+     */
+    protected function collectPendingPrimaries(): void
+    {
+        $now = hrtime(true);
+        $deadline = $this->timeout === null ? null : $now - (int)($this->timeout * 1e9);
+        $overflow = count($this->pendingPrimaries) - static::MAX_PENDING_PRIMARIES;
+        foreach ($this->pendingPrimaries as $index => [$start, $completion, $discard, $lastSeen]) {
+            if ($completion->isComplete()) {
+                $this->recordPrimary($start, $lastSeen, $now);
+                if ($discard !== null) {
+                    $discard($completion);
+                }
+                $overflow--;
+            } else if ($overflow > 0 || ($deadline !== null && $start <= $deadline)) {
+                $this->abandonedPrimaryCount++;
+                $this->abandon($completion, $discard);
+                $overflow--;
+            } else {
+                $this->pendingPrimaries[$index][3] = $now;
+                continue;
+            }
+            unset($this->pendingPrimaries[$index]);
+        }
+        $this->pendingPrimaries = array_values($this->pendingPrimaries);
+    }
+
+    /**
+     * Record the latency of a losing first attempt that was found complete at $now
+     *
+     * @param int $start
+     * @param int $lastSeen - time of the last check that found the attempt incomplete
+     * @param int $now
+     * @return void
+     */
+    protected function recordPrimary(int $start, int $lastSeen, int $now): void
+    {
+        if (($now - $lastSeen) / 1e9 > static::PRIMARY_LATENCY_RESOLUTION) {
+            $this->unmeasuredPrimaryCount++;
+            return;
+        }
+        $this->primaryLatencies->record(($now - $start) / 1e9);
+    }
+
+    /**
+     * Cancel a completion and wait until librados has finished it, since it may still write into its result buffers
+     *
+     * @param ResultCompletion $completion
+     * @param Closure|null $discard
+     * @return void
+     */
+    protected function abandon(ResultCompletion $completion, ?Closure $discard): void
+    {
+        try {
+            $completion->cancel();
+        } catch (RadosException) {
+            // The operation may already have completed
+        }
+        $completion->waitForComplete();
+        if ($discard !== null) {
+            $discard($completion);
+        }
+    }
+}
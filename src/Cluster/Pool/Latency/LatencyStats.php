@@ -0,0 +1,100 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Latency;
+
+use InvalidArgumentException;
+
+/**
+ * Keeps the most recent latency samples and calculates percentiles from them
+ */
+class LatencyStats
+{
+    /**
+     * @var float[]
+     */
+    protected array $samples = [];
+    protected int $position = 0;
+    protected int $totalCount = 0;
+
+    /**
+     * @param int $capacity - maximum number of samples to keep
+     */
+    public function __construct(protected int $capacity = 1024)
+    {
+        if ($this->capacity < 1) {
+            throw new InvalidArgumentException("Capacity must be at least 1");
+        }
+    }
+
+    /**
+     * Record a latency sample
+     *
+     * @param float $latency - latency in seconds
+     * @return $this
+     */
+    public function record(float $latency): static
+    {
+        $this->samples[$this->position] = $latency;
+        $this->position = ($this->position + 1) % $this->capacity;
+        $this->totalCount++;
+        return $this;
+    }
+
+    /**
+     * Get a percentile of the recorded samples
+     *
+     * @param float $percentile - percentile between 0 and 100
+     * @return float|null - latency in seconds, null if no samples were recorded
+     */
+    public function getPercentile(float $percentile): ?float
+    {
+        if ($percentile < 0 || $percentile > 100) {
+            throw new InvalidArgumentException("Percentile must be between 0 and 100");
+        }
+        if (count($this->samples) === 0) {
+            return null;
+        }
+
+        $sorted = $this->samples;
+        sort($sorted);
+        $index = (int)ceil($percentile / 100 * count($sorted)) - 1;
+        return $sorted[max(0, $index)];
+    }
+
+    /**
+     * @return float|null
+     */
+    public function getP50(): ?float
+    {
+        return $this->getPercentile(50);
+    }
+
+    /**
+     * @return float|null
+     */
+    public function getP99(): ?float
+    {
+        return $this->getPercentile(99);
+    }
+
+    /**
+     * Get the number of samples recorded since creation or the last reset
+     *
+     * @return int
+     */
+    public function getCount(): int
+    {
+        return $this->totalCount;
+    }
+
+    /**
+     * @return $this
+     */
+    public function reset(): static
+    {
+        $this->samples = [];
+        $this->position = 0;
+        $this->totalCount = 0;
+        return $this;
+    }
+}
@@ -0,0 +1,113 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Mirror;
+
+use Aternos\Rados\Cluster\Pool\ObjectIterator\ObjectIterator;
+use Aternos\Rados\Exception\RadosException;
+use Generator;
+
+/**
+ * Copies the objects that exist in the primary of a MirroredIOContext to its secondary
+ *
+ * The backfill can be run in slices by passing a limit to run(), so it can progress
+ * in the background of a long-running process between other work, while new writes are mirrored.
+ * Objects are copied in parallel by the ObjectSynchronizer. Objects that fail to copy are
+ * added to the retry queue of the mirrored io context.
+ *
+ * @note Objects that are written by other processes while they are being copied can end up
+ * with an older state on the secondary. If other processes write to the primary during the backfill,
+ * they should use a MirroredIOContext as well, and the backfill should be run again afterwards.
+ */
+class MirrorBackfill
+{
+    protected ?ObjectIterator $iterator = null;
+    protected bool $finished = false;
+    protected int $copiedCount = 0;
+    protected int $failedCount = 0;
+
+    /**
+     * @param MirroredIOContext $ioContext
+     * @param ObjectSynchronizer $synchronizer
+     */
+    public function __construct(
+        protected MirroredIOContext $ioContext,
+        protected ObjectSynchronizer $synchronizer
+    )
+    {
+    }
+
+    /**
+     * Copy the next objects
+     *
+     * @param int|null $limit - maximum number of objects to copy in this call, or null for all remaining objects
+     * @return int - number of objects copied in this call
+     * @throws RadosException
+     */
+    public function run(?int $limit = null): int
+    {
+        if ($this->finished) {
+            return 0;
+        }
+        $this->ioContext->poll();
+        $this->ioContext->getPrimary()->flushAsyncWrites();
+
+        $count = 0;
+        $failures = $this->synchronizer->synchronize($this->nextObjectIds($limit, $count));
+        foreach ($failures as $objectId => $exception) {
+            $this->ioContext->queueResync($objectId);
+        }
+
+        $copied = $count - count($failures);
+        $this->copiedCount += $copied;
+        $this->failedCount += count($failures);
+        return $copied;
+    }
+
+    /**
+     * @return bool
+     */
+    public function isFinished(): bool
+    {
+        return $this->finished;
+    }
+
+    /**
+     * @return int
+     */
+    public function getCopiedCount(): int
+    {
+        return $this->copiedCount;
+    }
+
+    /**
+     * Get the number of objects that failed to copy and were added to the retry queue
+     *
+     * @return int
+     */
+    public function getFailedCount(): int
+    {
+        return $this->failedCount;
+    }
+
+    /**
+     * @param int|null $limit
+     * @param int $count - number of returned object ids
+     * @return Generator<string>
+     * @throws RadosException
+     */
+    protected function nextObjectIds(?int $limit, int &$count): Generator
+    {
+        $this->iterator ??= $this->ioContext->getPrimary()->createObjectIterator();
+        while ($limit === null || $count < $limit) {
+            if (!$this->iterator->valid()) {
+                $this->finished = true;
+                $this->iterator = null;
+                return;
+            }
+            $objectId = $this->iterator->current()->getEntry();
+            $this->iterator->next();
+            $count++;
+            yield $objectId;
+        }
+    }
+}
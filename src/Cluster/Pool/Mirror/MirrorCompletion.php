@@ -0,0 +1,114 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Mirror;
+
+use Aternos\Rados\Completion\ResultCompletion;
+use Aternos\Rados\Exception\MirrorException;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Generated\Errno;
+
+/**
+ * Completion of a write that was sent to the primary and the secondary io context
+ *
+ * @template T
+ */
+class MirrorCompletion
+{
+    /**
+     * @param MirroredIOContext $ioContext
+     * @param string $objectId
+     * @param MirrorMode $mode
+     * @param ResultCompletion<T> $primary
+     * @param ResultCompletion $secondary
+     * @internal Mirror completions are returned from MirroredObject and should not be created manually
+     */
+    public function __construct(
+        protected MirroredIOContext $ioContext,
+        protected string $objectId,
+        protected MirrorMode $mode,
+        protected ResultCompletion $primary,
+        protected ResultCompletion $secondary
+    )
+    {
+    }
+
+    /**
+     * @return ResultCompletion<T>
+     */
+    public function getPrimary(): ResultCompletion
+    {
+        return $this->primary;
+    }
+
+    /**
+     * @return ResultCompletion
+     */
+    public function getSecondary(): ResultCompletion
+    {
+        return $this->secondary;
+    }
+
+    /**
+     * @return MirrorMode
+     */
+    public function getMode(): MirrorMode
+    {
+        return $this->mode;
+    }
+
+    /**
+     * Check if the write is complete according to the mirror mode
+     *
+     * @return bool
+     */
+    public function isComplete(): bool
+    {
+        if ($this->mode === MirrorMode::Primary) {
+            return $this->primary->isComplete();
+        }
+        return $this->primary->isComplete() && $this->secondary->isComplete();
+    }
+
+    /**
+     * Wait until the write is complete according to the mirror mode
+     *
+     * @return $this
+     */
+    public function waitForComplete(): static
+    {
+        $this->primary->waitForComplete();
+        if ($this->mode === MirrorMode::Both) {
+            $this->secondary->waitForComplete();
+        }
+        return $this;
+    }
+
+    /**
+     * Wait until the write is complete and get the result of the primary write
+     *
+     * If the secondary write fails in Both mode, the object is queued for resynchronization
+     * and a MirrorException is thrown. If the object does not exist on the secondary, it is queued
+     * for resynchronization without an exception, removals of missing objects succeed.
+     *
+     * @return T
+     * @throws RadosException
+     */
+    public function waitAndGetResult(): mixed
+    {
+        $this->waitForComplete();
+        if ($this->mode === MirrorMode::Both) {
+            $this->ioContext->poll();
+        }
+        $result = $this->primary->waitAndGetResult();
+
+        $secondaryResult = $this->secondary->getReturnValue();
+        if ($this->mode === MirrorMode::Both && $secondaryResult < 0 && $secondaryResult !== -Errno::ENOENT->value) {
+            try {
+                $this->secondary->waitAndGetResult();
+            } catch (RadosException $e) {
+                throw new MirrorException("Write to secondary failed for object " . $this->objectId . ": " . $e->getMessage(), $e->getCode(), $e);
+            }
+        }
+        return $result;
+    }
+}
@@ -0,0 +1,21 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Mirror;
+
+/**
+ * When a mirrored write is reported as complete
+ */
+enum MirrorMode
+{
+    /**
+     * Complete when the writes to the primary and the secondary have finished,
+     * a failed secondary write is reported to the caller
+     */
+    case Both;
+
+    /**
+     * Complete when the write to the primary has finished,
+     * the secondary write is tracked in the background and retried if it fails
+     */
+    case Primary;
+}
@@ -0,0 +1,316 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Mirror;
+
+use Aternos\Rados\Cluster\Pool\IOContext;
+use Aternos\Rados\Completion\ResultCompletion;
+use Aternos\Rados\Exception\MirrorException;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Generated\Errno;
+use InvalidArgumentException;
+
+/**
+ * Sends all writes to a primary and a secondary io context, e.g. to migrate data to another pool or cluster
+ *
+ * Writes are submitted to both io contexts concurrently using the async APIs. Reads should use the primary.
+ * Writes are only applied to secondary objects that exist. If the object has not been copied
+ * to the secondary yet, or the outcome of a write differs between primary and secondary (e.g. the secondary
+ * write failed), the object is queued for resynchronization, which copies the whole object from the primary
+ * to the secondary. Resynchronization is retried up
+ * to $maxAttempts times, objects that still fail are reported by flush().
+ *
+ * The number of tracked secondary writes and queued objects is bounded by $maxQueueSize,
+ * when the limit is reached, new writes wait for the oldest secondary write or process the queue.
+ */
+class MirroredIOContext
+{
+    const DEFAULT_MAX_QUEUE_SIZE = 1024;
+    const DEFAULT_MAX_ATTEMPTS = 3;
+
+    /**
+     * @var array{string, ResultCompletion, ResultCompletion, bool}[]
+     */
+    protected array $pending = [];
+
+    /**
+     * @var array<string, int> - number of failed attempts by object id
+     */
+    protected array $retryQueue = [];
+
+    /**
+     * @var array<string, RadosException>
+     */
+    protected array $failedObjects = [];
+
+    protected ?ObjectSynchronizer $synchronizer = null;
+
+    /**
+     * @param IOContext $primary
+     * @param IOContext $secondary
+     * @param MirrorMode $mode
+     * @param int $maxQueueSize - maximum number of tracked secondary writes and of objects waiting for resynchronization
+     * @param int $maxAttempts - maximum number of resynchronization attempts per object
+     */
+    public function __construct(
+        protected IOContext $primary,
+        protected IOContext $secondary,
+        protected MirrorMode $mode = MirrorMode::Both,
+        protected int $maxQueueSize = self::DEFAULT_MAX_QUEUE_SIZE,
+        protected int $maxAttempts = self::DEFAULT_MAX_ATTEMPTS
+    )
+    {
+        if ($maxQueueSize < 1 || $maxAttempts < 1) {
+            throw new InvalidArgumentException("Queue size and attempts must be positive");
+        }
+    }
+
+    /**
+     * @return IOContext
+     */
+    public function getPrimary(): IOContext
+    {
+        return $this->primary;
+    }
+
+    /**
+     * @return IOContext
+     */
+    public function getSecondary(): IOContext
+    {
+        return $this->secondary;
+    }
+
+    /**
+     * @return MirrorMode
+     */
+    public function getMode(): MirrorMode
+    {
+        return $this->mode;
+    }
+
+    /**
+     * @param MirrorMode $mode
+     * @return $this
+     */
+    public function setMode(MirrorMode $mode): static
+    {
+        $this->mode = $mode;
+        return $this;
+    }
+
+    /**
+     * @param string $objectId
+     * @return MirroredObject
+     */
+    public function getObject(string $objectId): MirroredObject
+    {
+        return new MirroredObject($objectId, $this);
+    }
+
+    /**
+     * Get the synchronizer used to copy objects from the primary to the secondary
+     *
+     * @return ObjectSynchronizer
+     */
+    public function getSynchronizer(): ObjectSynchronizer
+    {
+        return $this->synchronizer ??= new ObjectSynchronizer($this->primary, $this->secondary);
+    }
+
+    /**
+     * @param ObjectSynchronizer $synchronizer
+     * @return $this
+     */
+    public function setSynchronizer(ObjectSynchronizer $synchronizer): static
+    {
+        $this->synchronizer = $synchronizer;
+        return $this;
+    }
+
+    /**
+     * Create a backfill that copies all existing objects from the primary to the secondary
+     *
+     * @param int $concurrency - number of objects copied in parallel
+     * @param int $chunkSize - maximum number of bytes per read and write
+     * @return MirrorBackfill
+     */
+    public function createBackfill(
+        int $concurrency = ObjectSynchronizer::DEFAULT_CONCURRENCY,
+        int $chunkSize = ObjectSynchronizer::DEFAULT_CHUNK_SIZE
+    ): MirrorBackfill
+    {
+        return new MirrorBackfill($this, new ObjectSynchronizer($this->primary, $this->secondary, $concurrency, $chunkSize));
+    }
+
+    /**
+     * Track the primary and secondary completion of a mirrored write
+     *
+     * @template T
+     * @param string $objectId
+     * @param ResultCompletion<T> $primary
+     * @param ResultCompletion $secondary
+     * @param bool $removal - whether the write removes the object, objects missing on either side count as removed
+     * @return MirrorCompletion<T>
+     * @throws RadosException
+     * @internal Used by MirroredObject
+     */
+    public function track(string $objectId, ResultCompletion $primary, ResultCompletion $secondary, bool $removal = false): MirrorCompletion
+    {
+        $this->poll();
+        while (count($this->pending) >= $this->maxQueueSize) {
+            $this->settle(array_shift($this->pending));
+        }
+        if (count($this->retryQueue) >= $this->maxQueueSize) {
+            $this->processRetryQueue();
+        }
+
+        $this->pending[] = [$objectId, $primary, $secondary, $removal];
+        return new MirrorCompletion($this, $objectId, $this->mode, $primary, $secondary);
+    }
+
+    /**
+     * Check tracked writes without blocking and queue objects with differing outcomes for resynchronization
+     *
+     * @return $this
+     */
+    public function poll(): static
+    {
+        foreach ($this->pending as $index => $entry) {
+            [, $primary, $secondary] = $entry;
+            if ($primary->isComplete() && $secondary->isComplete()) {
+                unset($this->pending[$index]);
+                $this->settle($entry);
+            }
+        }
+        $this->pending = array_values($this->pending);
+        return $this;
+    }
+
+    /**
+     * Queue an object to be copied from the primary to the secondary
+     *
+     * @param string $objectId
+     * @return $this
+     */
+    public function queueResync(string $objectId): static
+    {
+        $this->retryQueue[$objectId] ??= 0;
+        return $this;
+    }
+
+    /**
+     * Copy all queued objects from the primary to the secondary
+     *
+     * Async writes to the primary are flushed first, so the copies include all writes submitted so far.
+     * Objects that fail are queued again until they reach the maximum number of attempts.
+     *
+     * @return $this
+     * @throws RadosException
+     */
+    public function processRetryQueue(): static
+    {
+        if (count($this->retryQueue) === 0) {
+            return $this;
+        }
+        $this->primary->flushAsyncWrites();
+
+        $queue = $this->retryQueue;
+        $this->retryQueue = [];
+        $failures = $this->getSynchronizer()->synchronize(array_keys($queue));
+        foreach ($failures as $objectId => $exception) {
+            $attempts = $queue[$objectId] + 1;
+            if ($attempts >= $this->maxAttempts) {
+                $this->failedObjects[$objectId] = $exception;
+            } else {
+                $this->retryQueue[$objectId] = max($attempts, $this->retryQueue[$objectId] ?? 0);
+            }
+        }
+        return $this;
+    }
+
+    /**
+     * Wait for all tracked writes and process the retry queue until it is empty
+     *
+     * @return $this
+     * @throws MirrorException - if objects could not be mirrored after the maximum number of attempts
+     * @throws RadosException
+     */
+    public function flush(): static
+    {
+        while (count($this->pending) > 0) {
+            $this->settle(array_shift($this->pending));
+        }
+        while (count($this->retryQueue) > 0) {
+            $this->processRetryQueue();
+        }
+
+        if (count($this->failedObjects) > 0) {
+            throw new MirrorException(count($this->failedObjects) . " objects could not be mirrored to the secondary: "
+                . implode(", ", array_slice(array_keys($this->failedObjects), 0, 10)));
+        }
+        return $this;
+    }
+
+    /**
+     * @return int
+     */
+    public function getPendingCount(): int
+    {
+        return count($this->pending);
+    }
+
+    /**
+     * @return int
+     */
+    public function getRetryQueueSize(): int
+    {
+        return count($this->retryQueue);
+    }
+
+    /**
+     * Get the objects that could not be mirrored after the maximum number of attempts
+     *
+     * @return array<string, RadosException> - last exception by object id
+     */
+    public function getFailedObjects(): array
+    {
+        return $this->failedObjects;
+    }
+
+    /**
+     * @return $this
+     */
+    public function clearFailedObjects(): static
+    {
+        $this->failedObjects = [];
+        return $this;
+    }
+
+    /**
+     * Wait for a tracked write and queue the object if the outcomes differ
+     * or if the object is missing on the secondary
+     *
+     * @param array{string, ResultCompletion, ResultCompletion, bool} $entry
+     * @return void
+     */
+    protected function settle(array $entry): void
+    {
+        [$objectId, $primary, $secondary, $removal] = $entry;
+        $primary->waitForComplete();
+        $secondary->waitForComplete();
+        $primaryResult = $primary->getReturnValue();
+        $secondaryResult = $secondary->getReturnValue();
+        $missing = -Errno::ENOENT->value;
+
+        if ($removal) {
+            $primaryResult = $primaryResult === $missing ? 0 : $primaryResult;
+            $secondaryResult = $secondaryResult === $missing ? 0 : $secondaryResult;
+        } else if ($secondaryResult === $missing && $primaryResult !== $missing) {
+            $this->queueResync($objectId);
+            return;
+        }
+        if (($primaryResult < 0) !== ($secondaryResult < 0)) {
+            $this->queueResync($objectId);
+        }
+    }
+}
@@ -0,0 +1,291 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Mirror;
+
+use Aternos\Rados\Cluster\Pool\Object\RadosObject;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Operation\Common\Task\AssertExistsTask;
+use Aternos\Rados\Operation\OperationTask;
+use Aternos\Rados\Operation\Write\Task\AppendTask;
+use Aternos\Rados\Operation\Write\Task\RemoveXAttributeTask;
+use Aternos\Rados\Operation\Write\Task\SetXAttributeTask;
+use Aternos\Rados\Operation\Write\Task\WriteFullTask;
+use Aternos\Rados\Operation\Write\Task\WriteTask;
+use Aternos\Rados\Operation\Write\WriteOperation;
+use Aternos\Rados\Util\Buffer\Buffer;
+use Aternos\Rados\Util\Buffer\BufferView;
+use Aternos\Rados\Util\TimeSpec;
+use Closure;
+
+/**
+ * Object whose writes are sent to the primary and the secondary io context of a MirroredIOContext
+ *
+ * Synchronous methods wait for the write according to the mirror mode of the io context.
+ * Reads should use the primary object.
+ *
+ * Writes are executed on the secondary object only if it exists, otherwise the object is queued to be copied
+ * from the primary, so no partial objects are created on the secondary. This includes writeFull(), which replaces
+ * the data but keeps the xattrs and omap entries of an object. New objects therefore reach the secondary when
+ * the queue is processed. Removing an object that does not exist on the secondary succeeds.
+ *
+ * @note Write data is copied by librados when a write is submitted and failed secondary writes are
+ * repaired by copying the object from the primary, so buffers can be reused as soon as a write has been started.
+ */
+class MirroredObject
+{
+    /**
+     * @param string $id
+     * @param MirroredIOContext $ioContext
+     */
+    public function __construct(protected string $id, protected MirroredIOContext $ioContext)
+    {
+    }
+
+    /**
+     * @return string
+     */
+    public function getId(): string
+    {
+        return $this->id;
+    }
+
+    /**
+     * @return MirroredIOContext
+     */
+    public function getIOContext(): MirroredIOContext
+    {
+        return $this->ioContext;
+    }
+
+    /**
+     * @return RadosObject
+     */
+    public function getPrimary(): RadosObject
+    {
+        return $this->ioContext->getPrimary()->getObject($this->id);
+    }
+
+    /**
+     * @return RadosObject
+     */
+    public function getSecondary(): RadosObject
+    {
+        return $this->ioContext->getSecondary()->getObject($this->id);
+    }
+
+    /**
+     * Write data to both objects, starting at offset $offset
+     *
+     * @param string|Buffer|BufferView $buffer
+     * @param int $offset
+     * @return $this
+     * @throws RadosException
+     */
+    public function write(string|Buffer|BufferView $buffer, int $offset): static
+    {
+        $this->writeAsync($buffer, $offset)->waitAndGetResult();
+        return $this;
+    }
+
+    /**
+     * Replace the content of both objects
+     *
+     * @param string|Buffer|BufferView $buffer
+     * @return $this
+     * @throws RadosException
+     */
+    public function writeFull(string|Buffer|BufferView $buffer): static
+    {
+        $this->writeFullAsync($buffer)->waitAndGetResult();
+        return $this;
+    }
+
+    /**
+     * Append data to both objects
+     *
+     * @param string|Buffer|BufferView $buffer
+     * @return $this
+     * @throws RadosException
+     */
+    public function append(string|Buffer|BufferView $buffer): static
+    {
+        $this->appendAsync($buffer)->waitAndGetResult();
+        return $this;
+    }
+
+    /**
+     * Remove both objects
+     *
+     * @return $this
+     * @throws RadosException
+     */
+    public function remove(): static
+    {
+        $this->removeAsync()->waitAndGetResult();
+        return $this;
+    }
+
+    /**
+     * Set an extended attribute on both objects
+     *
+     * @param string $name
+     * @param string $value
+     * @return $this
+     * @throws RadosException
+     */
+    public function setXAttribute(string $name, string $value): static
+    {
+        $this->setXAttributeAsync($name, $value)->waitAndGetResult();
+        return $this;
+    }
+
+    /**
+     * Remove an extended attribute from both objects
+     *
+     * @param string $name
+     * @return $this
+     * @throws RadosException
+     */
+    public function removeXAttribute(string $name): static
+    {
+        $this->removeXAttributeAsync($name)->waitAndGetResult();
+        return $this;
+    }
+
+    /**
+     * Execute a write operation on both objects
+     *
+     * Operations can only be executed once, so the tasks are created by a factory that is called once per object.
+     * On the secondary, the operation is only executed if the object exists, otherwise the object is queued
+     * to be copied from the primary. This also applies to operations that create the object.
+     *
+     * @param Closure(): OperationTask[] $taskFactory - returns new task instances on each call
+     * @param TimeSpec|null $mtime
+     * @param array $flags
+     * @return OperationTask[] - tasks of the primary operation
+     * @throws RadosException
+     */
+    public function operate(Closure $taskFactory, ?TimeSpec $mtime = null, array $flags = []): array
+    {
+        return $this->operateAsync($taskFactory, $mtime, $flags)->waitAndGetResult();
+    }
+
+    /**
+     * @param string|Buffer|BufferView $buffer
+     * @param int $offset
+     * @return MirrorCompletion<null>
+     * @throws RadosException
+     */
+    public function writeAsync(string|Buffer|BufferView $buffer, int $offset): MirrorCompletion
+    {
+        return $this->ioContext->track($this->id,
+            $this->getPrimary()->writeAsync($buffer, $offset),
+            $this->createSecondaryOperation([new WriteTask($buffer, $offset)])->operateAsync($this->getSecondary())
+        );
+    }
+
+    /**
+     * @param string|Buffer|BufferView $buffer
+     * @return MirrorCompletion<null>
+     * @throws RadosException
+     */
+    public function writeFullAsync(string|Buffer|BufferView $buffer): MirrorCompletion
+    {
+        return $this->ioContext->track($this->id,
+            $this->getPrimary()->writeFullAsync($buffer),
+            $this->createSecondaryOperation([new WriteFullTask($buffer)])->operateAsync($this->getSecondary())
+        );
+    }
+
+    /**
+     * @param string|Buffer|BufferView $buffer
+     * @return MirrorCompletion<null>
+     * @throws RadosException
+     */
+    public function appendAsync(string|Buffer|BufferView $buffer): MirrorCompletion
+    {
+        return $this->ioContext->track($this->id,
+            $this->getPrimary()->appendAsync($buffer),
+            $this->createSecondaryOperation([new AppendTask($buffer)])->operateAsync($this->getSecondary())
+        );
+    }
+
+    /**
+     * @return MirrorCompletion<null>
+     * @throws RadosException
+     */
+    public function removeAsync(): MirrorCompletion
+    {
+        return $this->ioContext->track($this->id,
+            $this->getPrimary()->removeAsync(),
+            $this->getSecondary()->removeAsync(),
+            true
+        );
+    }
+
+    /**
+     * @param string $name
+     * @param string $value
+     * @return MirrorCompletion<null>
+     * @throws RadosException
+     */
+    public function setXAttributeAsync(string $name, string $value): MirrorCompletion
+    {
+        return $this->ioContext->track($this->id,
+            $this->getPrimary()->setXAttributeAsync($name, $value),
+            $this->createSecondaryOperation([new SetXAttributeTask($name, $value)])->operateAsync($this->getSecondary())
+        );
+    }
+
+    /**
+     * @param string $name
+     * @return MirrorCompletion<null>
+     * @throws RadosException
+     */
+    public function removeXAttributeAsync(string $name): MirrorCompletion
+    {
+        return $this->ioContext->track($this->id,
+            $this->getPrimary()->removeXAttributeAsync($name),
+            $this->createSecondaryOperation([new RemoveXAttributeTask($name)])->operateAsync($this->getSecondary())
+        );
+    }
+
+    /**
+     * @param Closure(): OperationTask[] $taskFactory - returns new task instances on each call
+     * @param TimeSpec|null $mtime
+     * @param array $flags
+     * @return MirrorCompletion<OperationTask[]>
+     * @throws RadosException
+     */
+    public function operateAsync(Closure $taskFactory, ?TimeSpec $mtime = null, array $flags = []): MirrorCompletion
+    {
+        return $this->ioContext->track($this->id,
+            $this->createOperation($taskFactory())->operateAsync($this->getPrimary(), $mtime, $flags),
+            $this->createSecondaryOperation($taskFactory())->operateAsync($this->getSecondary(), $mtime, $flags)
+        );
+    }
+
+    /**
+     * @param OperationTask[] $tasks
+     * @return WriteOperation
+     */
+    protected function createOperation(array $tasks): WriteOperation
+    {
+        $operation = WriteOperation::create($this->ioContext->getPrimary()->getFFI());
+        foreach ($tasks as $task) {
+            $operation->addTask($task);
+        }
+        return $operation;
+    }
+
+    /**
+     * Create an operation for the secondary object that fails with ENOENT if the object has not been copied yet
+     *
+     * @param OperationTask[] $tasks
+     * @return WriteOperation
+     */
+    protected function createSecondaryOperation(array $tasks): WriteOperation
+    {
+        return $this->createOperation([new AssertExistsTask(), ...$tasks]);
+    }
+}
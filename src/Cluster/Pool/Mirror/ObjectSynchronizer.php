@@ -0,0 +1,320 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Mirror;
+
+use Aternos\Rados\Cluster\Pool\IOContext;
+use Aternos\Rados\Cluster\Pool\Object\RadosObject;
+use Aternos\Rados\Completion\OperationCompletion;
+use Aternos\Rados\Completion\ReadCompletion;
+use Aternos\Rados\Constants\CreateMode;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Exception\RadosObjectException;
+use Aternos\Rados\Generated\Errno;
+use Aternos\Rados\Operation\Read\ReadOperation;
+use Aternos\Rados\Operation\Read\Task\GetXAttributesTask;
+use Aternos\Rados\Operation\Read\Task\OMapGetTask;
+use Aternos\Rados\Operation\Read\Task\ReadTask;
+use Aternos\Rados\Operation\Read\Task\StatTask;
+use Aternos\Rados\Operation\Write\Task\CreateObjectTask;
+use Aternos\Rados\Operation\Write\Task\OMapSetTask;
+use Aternos\Rados\Operation\Write\Task\RemoveTask;
+use Aternos\Rados\Operation\Write\Task\SetXAttributeTask;
+use Aternos\Rados\Operation\Write\Task\WriteTask;
+use Aternos\Rados\Operation\Write\WriteOperation;
+use Aternos\Rados\Util\Buffer\Buffer;
+use Aternos\Rados\Util\TimeSpec;
+use InvalidArgumentException;
+
+/**
+ * Copies objects with their data, xattrs and omap entries from a source to a target io context
+ *
+ * The target object is removed and recreated, so it ends up with exactly the state the source
+ * object had when it was read. If the source object does not exist, the target object is removed.
+ * Up to $concurrency objects are read in parallel, writes to the target are pipelined
+ * with up to $concurrency write operations in flight.
+ */
+class ObjectSynchronizer
+{
+    const DEFAULT_CONCURRENCY = 16;
+    const DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;
+    const DEFAULT_OMAP_BATCH_SIZE = 1024;
+    const READ_AHEAD = 4;
+
+    /**
+     * @var array{string, OperationCompletion, bool}[]
+     */
+    protected array $writes = [];
+
+    /**
+     * @var array<string, RadosException>
+     */
+    protected array $failures = [];
+
+    /**
+     * @var Buffer[]
+     */
+    protected array $buffers = [];
+
+    /**
+     * @param IOContext $source
+     * @param IOContext $target
+     * @param int $concurrency - maximum number of objects read and write operations in flight
+     * @param int $chunkSize - maximum number of data bytes per read and write operation
+     * @param int $omapBatchSize - maximum number of omap entries per read and write operation
+     */
+    public function __construct(
+        protected IOContext $source,
+        protected IOContext $target,
+        protected int $concurrency = self::DEFAULT_CONCURRENCY,
+        protected int $chunkSize = self::DEFAULT_CHUNK_SIZE,
+        protected int $omapBatchSize = self::DEFAULT_OMAP_BATCH_SIZE
+    )
+    {
+        if ($concurrency < 1 || $chunkSize < 1 || $omapBatchSize < 1) {
+            throw new InvalidArgumentException("Concurrency, chunk size and omap batch size must be positive");
+        }
+    }
+
+    /**
+     * Copy objects from the source to the target
+     *
+     * Failures of single objects do not stop the synchronization, they are returned instead.
+     *
+     * @param iterable<string> $objectIds
+     * @return array<string, RadosException> - exceptions of objects that could not be copied, by object id
+     */
+    public function synchronize(iterable $objectIds): array
+    {
+        $this->failures = [];
+        $pending = [];
+        foreach ($objectIds as $objectId) {
+            $pending[] = $this->readObjectAsync($objectId);
+            if (count($pending) >= $this->concurrency) {
+                $this->copyObject(array_shift($pending));
+            }
+        }
+        while (count($pending) > 0) {
+            $this->copyObject(array_shift($pending));
+        }
+        while (count($this->writes) > 0) {
+            $this->settleWrite(array_shift($this->writes));
+        }
+
+        $failures = $this->failures;
+        $this->failures = [];
+        return $failures;
+    }
+
+    /**
+     * Copy a single object
+     *
+     * @param string $objectId
+     * @return $this
+     * @throws RadosException
+     */
+    public function synchronizeObject(string $objectId): static
+    {
+        $failures = $this->synchronize([$objectId]);
+        if (isset($failures[$objectId])) {
+            throw $failures[$objectId];
+        }
+        return $this;
+    }
+
+    /**
+     * @return IOContext
+     */
+    public function getSource(): IOContext
+    {
+        return $this->source;
+    }
+
+    /**
+     * @return IOContext
+     */
+    public function getTarget(): IOContext
+    {
+        return $this->target;
+    }
+
+    /**
+     * Start reading stat, xattrs, the first omap batch and the first data chunk of a source object
+     *
+     * @param string $objectId
+     * @return array{string, StatTask, GetXAttributesTask, OMapGetTask, ReadTask, ?OperationCompletion, ?RadosException}
+     */
+    protected function readObjectAsync(string $objectId): array
+    {
+        $stat = new StatTask();
+        $xAttributes = new GetXAttributesTask();
+        $omap = new OMapGetTask($this->omapBatchSize);
+        $read = new ReadTask($this->chunkSize, 0);
+
+        try {
+            $completion = ReadOperation::create($this->source->getFFI())
+                ->addTask($stat)
+                ->addTask($xAttributes)
+                ->addTask($omap)
+                ->addTask($read)
+                ->operateAsync($this->source->getObject($objectId));
+            return [$objectId, $stat, $xAttributes, $omap, $read, $completion, null];
+        } catch (RadosException $e) {
+            return [$objectId, $stat, $xAttributes, $omap, $read, null, $e];
+        }
+    }
+
+    /**
+     * Wait for the read of a source object and write it to the target
+     *
+     * @param array{string, StatTask, GetXAttributesTask, OMapGetTask, ReadTask, ?OperationCompletion, ?RadosException} $pending
+     * @return void
+     */
+    protected function copyObject(array $pending): void
+    {
+        [$objectId, $statTask, $xAttributesTask, $omapTask, $readTask, $completion, $exception] = $pending;
+        try {
+            if ($exception !== null) {
+                throw $exception;
+            }
+            try {
+                $completion->waitAndGetResult();
+            } catch (RadosException $e) {
+                if (!$e->is(Errno::ENOENT)) {
+                    throw $e;
+                }
+                $this->submitWrite($objectId, $this->writeOperation()->addTask(new RemoveTask()), null, true);
+                return;
+            }
+
+            $stat = $statTask->getResult();
+            $modifiedTime = $stat->getModifiedTime();
+            $this->submitWrite($objectId, $this->writeOperation()->addTask(new RemoveTask()), null, true);
+
+            $operation = $this->writeOperation()->addTask(new CreateObjectTask(CreateMode::Idempotent));
+            foreach ($xAttributesTask->getResult() as $name => $value) {
+                $operation->addTask(new SetXAttributeTask($name, $value));
+            }
+            [$omapValues, $omapLast, $omapMore] = $this->readOMapResult($omapTask);
+            if (count($omapValues) > 0) {
+                $operation->addTask(new OMapSetTask($omapValues));
+            }
+            $data = $readTask->getResult();
+            if ($data !== "") {
+                $operation->addTask(new WriteTask($data, 0));
+            }
+            $this->submitWrite($objectId, $operation, $modifiedTime);
+
+            $source = $this->source->getObject($objectId);
+            while ($omapMore && $omapLast !== null) {
+                $task = new OMapGetTask($this->omapBatchSize, $omapLast);
+                ReadOperation::create($this->source->getFFI())->addTask($task)->operate($source);
+                [$omapValues, $omapLast, $omapMore] = $this->readOMapResult($task);
+                if (count($omapValues) > 0) {
+                    $this->submitWrite($objectId, $this->writeOperation()->addTask(new OMapSetTask($omapValues)), $modifiedTime);
+                }
+            }
+            $this->copyRemainingData($source, strlen($data), $stat->getSize(), $modifiedTime);
+        } catch (RadosException $e) {
+            $this->failures[$objectId] = $e;
+        }
+    }
+
+    /**
+     * @param OMapGetTask $task
+     * @return array{array<string, string>, ?string, bool} - values, last key, more entries available
+     */
+    protected function readOMapResult(OMapGetTask $task): array
+    {
+        $result = $task->getResult();
+        $values = [];
+        $last = null;
+        foreach ($result->getIterator() as $key => $value) {
+            $values[$key] = $value ?? "";
+            $last = $key;
+        }
+        return [$values, $last, $result->hasMore()];
+    }
+
+    /**
+     * Copy the data after the first chunk with up to READ_AHEAD reads in flight
+     * The data is read into reused buffers and written from these buffers without converting it to strings.
+     *
+     * @param RadosObject $source
+     * @param int $offset - offset of the first byte that has not been copied yet
+     * @param int $size - size of the source object
+     * @param TimeSpec $modifiedTime
+     * @return void
+     * @throws RadosException
+     */
+    protected function copyRemainingData(RadosObject $source, int $offset, int $size, TimeSpec $modifiedTime): void
+    {
+        /** @var array{int, Buffer, ReadCompletion}[] $reads */
+        $reads = [];
+        try {
+            while ($offset < $size || count($reads) > 0) {
+                while (count($reads) < static::READ_AHEAD && $offset < $size) {
+                    $length = min($this->chunkSize, $size - $offset);
+                    $buffer = array_pop($this->buffers) ?? Buffer::create($this->source->getFFI(), $this->chunkSize);
+                    $reads[] = [$offset, $buffer, $source->readAsync($length, $offset, $buffer)];
+                    $offset += $length;
+                }
+
+                [$chunkOffset, $buffer, $completion] = array_shift($reads);
+                $readLength = RadosObjectException::handle($completion->waitForComplete()->getReturnValue());
+                if ($readLength > 0) {
+                    $operation = $this->writeOperation()->addTask(new WriteTask($buffer->view(0, $readLength), $chunkOffset));
+                    $this->submitWrite($source->getId(), $operation, $modifiedTime);
+                }
+                $this->buffers[] = $buffer;
+            }
+        } finally {
+            foreach ($reads as [, $buffer, $completion]) {
+                $completion->waitForComplete();
+                $this->buffers[] = $buffer;
+            }
+        }
+    }
+
+    /**
+     * Submit a write operation to a target object, waiting for the oldest write if too many are in flight
+     *
+     * @param string $objectId
+     * @param WriteOperation $operation
+     * @param TimeSpec|null $modifiedTime
+     * @param bool $ignoreMissing - ignore ENOENT errors of this operation
+     * @return void
+     * @throws RadosException
+     */
+    protected function submitWrite(string $objectId, WriteOperation $operation, ?TimeSpec $modifiedTime, bool $ignoreMissing = false): void
+    {
+        while (count($this->writes) >= $this->concurrency) {
+            $this->settleWrite(array_shift($this->writes));
+        }
+        $completion = $operation->operateAsync($this->target->getObject($objectId), $modifiedTime);
+        $this->writes[] = [$objectId, $completion, $ignoreMissing];
+    }
+
+    /**
+     * @param array{string, OperationCompletion, bool} $write
+     * @return void
+     */
+    protected function settleWrite(array $write): void
+    {
+        [$objectId, $completion, $ignoreMissing] = $write;
+        try {
+            $completion->waitAndGetResult();
+        } catch (RadosException $e) {
+            if (!$ignoreMissing || !$e->is(Errno::ENOENT)) {
+                $this->failures[$objectId] ??= $e;
+            }
+        }
+    }
+
+    /**
+     * @return WriteOperation
+     */
+    protected function writeOperation(): WriteOperation
+    {
+        return WriteOperation::create($this->target->getFFI());
+    }
+}
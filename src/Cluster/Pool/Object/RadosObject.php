@@ -3,6 +3,7 @@
 namespace Aternos\Rados\Cluster\Pool\Object;
 
 use Aternos\Rados\Cluster\Pool\IOContext;
+use Aternos\Rados\Cluster\Pool\Latency\LatencyPolicy;
 use Aternos\Rados\Cluster\Pool\Object\Lock\ForeignLock;
 use Aternos\Rados\Cluster\Pool\Object\Lock\Lock;
 use Aternos\Rados\Cluster\Pool\Object\XAttributes\XAttributesIterator;
@@ -26,15 +27,26 @@ use Aternos\Rados\Constants\LockFlag;
 use Aternos\Rados\Exception\RadosException;
 use Aternos\Rados\Exception\RadosObjectException;
 use Aternos\Rados\Generated\Errno;
+use Aternos\Rados\Operation\Read\ReadOperation;
+use Aternos\Rados\Operation\Read\Task\ReadTask;
+use Aternos\Rados\Rados;
 use Aternos\Rados\Util\Buffer\Buffer;
+use Aternos\Rados\Util\Buffer\BufferView;
+use Aternos\Rados\Util\File\LocalFile;
 use Aternos\Rados\Util\TimeSpec;
 use Aternos\Rados\Util\TimeValue;
 use FFI;
 use InvalidArgumentException;
 use Random\RandomException;
+use Throwable;
 
 class RadosObject
 {
+    const COPY_CHUNK_SIZE = 4 * 1024 * 1024;
+    const COPY_CONCURRENCY = 4;
+    const TRANSFER_CHUNK_SIZE = 4 * 1024 * 1024;
+    const TRANSFER_CONCURRENCY = 8;
+
     /**
      * @param string $id
      * @param IOContext $ioContext
@@ -63,18 +75,18 @@ class RadosObject
      * Binding for rados_write
      * Write data from $buffer into this object, starting at offset $offset.
      *
-     * @param string $buffer - data to write
+     * @param string|Buffer|BufferView $buffer - data to write
      * @param int $offset - offset to start writing at
      * @return $this
      * @throws RadosException
      * @noinspection PhpUndefinedMethodInspection
      */
-    public function write(string $buffer, int $offset): static
+    public function write(string|Buffer|BufferView $buffer, int $offset): static
     {
         RadosObjectException::handle(
             $this->getIOContext()->getFFI()->rados_write($this->getIOContext()->getCData(),
                 $this->getId(),
-                $buffer, strlen($buffer), $offset
+                BufferView::pointer($buffer), BufferView::length($buffer), $offset
             ));
         return $this;
     }
@@ -86,16 +98,16 @@ class RadosObject
      * The object is filled with the provided data. If the object exists,
      * it is atomically truncated and then written.
      *
-     * @param string $buffer - data to write
+     * @param string|Buffer|BufferView $buffer - data to write
      * @return $this
      * @throws RadosException
      * @noinspection PhpUndefinedMethodInspection
      */
-    public function writeFull(string $buffer): static
+    public function writeFull(string|Buffer|BufferView $buffer): static
     {
         RadosObjectException::handle($this->getIOContext()->getFFI()->rados_write_full(
             $this->getIOContext()->getCData(),
-            $this->getId(), $buffer, strlen($buffer)
+            $this->getId(), BufferView::pointer($buffer), BufferView::length($buffer)
         ));
         return $this;
     }
@@ -127,16 +139,16 @@ class RadosObject
      * Binding for rados_append
      * Append bytes from $buffer to this object.
      *
-     * @param string $buffer - the data to append
+     * @param string|Buffer|BufferView $buffer - the data to append
      * @return $this
      * @throws RadosException
      * @noinspection PhpUndefinedMethodInspection
      */
-    public function append(string $buffer): static
+    public function append(string|Buffer|BufferView $buffer): static
     {
         RadosObjectException::handle($this->getIOContext()->getFFI()->rados_append(
             $this->getIOContext()->getCData(), $this->getId(),
-            $buffer, strlen($buffer)
+            BufferView::pointer($buffer), BufferView::length($buffer)
         ));
         return $this;
     }
@@ -150,15 +162,15 @@ class RadosObject
      *
      * @param int $length - the number of bytes to read
      * @param int $offset - the offset to start reading from in the object
-     * @param Buffer|null $readBuffer - Optional: temporary buffer to read into.
+     * @param Buffer|BufferView|null $readBuffer - Optional: temporary buffer to read into.
      *  Reusing a buffer for multiple reads can reduce memory usage and improve performance.
      * @return string
      * @throws RadosException
      * @noinspection PhpUndefinedMethodInspection
      */
-    public function read(int $length, int $offset, ?Buffer $readBuffer = null): string
+    public function read(int $length, int $offset, Buffer|BufferView|null $readBuffer = null): string
     {
-        if ($readBuffer !== null && $readBuffer->getSize() >= $length) {
+        if ($readBuffer !== null && BufferView::length($readBuffer) >= $length) {
             $buffer = $readBuffer;
         } else {
             $buffer = Buffer::create($this->getIOContext()->getFFI(), $length);
@@ -166,11 +178,244 @@ class RadosObject
 
         $readLength = RadosObjectException::handle($this->getIOContext()->getFFI()->rados_read(
             $this->getIOContext()->getCData(), $this->getId(),
-            $buffer->getCData(), $length, $offset
+            BufferView::pointer($buffer), $length, $offset
         ));
         return $buffer->readString($readLength);
     }
 
+    /**
+     * Read data from this object as hedged read
+     *
+     * If the read does not complete within the hedge delay of the latency policy,
+     * it is issued a second time with the hedge flags of the policy, so it can be served by a replica.
+     * The first read to complete wins, see LatencyPolicy::executeHedged for the other one.
+     *
+     * @param int $length - the number of bytes to read
+     * @param int $offset - the offset to start reading from in the object
+     * @param LatencyPolicy|null $policy - defaults to the latency policy of the IOContext
+     * @return string
+     * @throws RadosException
+     */
+    public function readHedged(int $length, int $offset, ?LatencyPolicy $policy = null): string
+    {
+        $policy ??= $this->getIOContext()->getLatencyPolicy() ?? new LatencyPolicy();
+        $completion = $policy->executeHedged(function (array $flags) use ($length, $offset) {
+            $operation = ReadOperation::create($this->getIOContext()->getFFI());
+            $operation->addTask(new ReadTask($length, $offset));
+            return $operation->operateAsync($this, null, $flags);
+        });
+
+        /** @var ReadTask $task */
+        [$task] = $completion->getResult();
+        return $task->getResult();
+    }
+
+    /**
+     * Copy the data of this object to another object, which can be in a different pool
+     *
+     * The data is read in chunks into reused buffers and written from these buffers,
+     * without copying it into PHP strings. Up to $concurrency reads and writes are in flight at the same time.
+     * The target object is truncated by the first write. Extended attributes and omap entries are not copied.
+     * If a read or write fails, the reads and writes still in flight are waited for before the exception is thrown.
+     *
+     * @note The data is copied by librados when a write is submitted, so a buffer can be reused for the next read
+     * as soon as its write has been started.
+     *
+     * @param RadosObject $target
+     * @param int $chunkSize - maximum number of bytes per read and write
+     * @param int $concurrency - maximum number of reads and writes in flight
+     * @return $this
+     * @throws RadosException
+     */
+    public function copyTo(RadosObject $target, int $chunkSize = self::COPY_CHUNK_SIZE, int $concurrency = self::COPY_CONCURRENCY): static
+    {
+        if ($chunkSize < 1 || $concurrency < 1) {
+            throw new InvalidArgumentException("Chunk size and concurrency must be positive");
+        }
+        if ($target->getIOContext() === $this->getIOContext() && $target->getId() === $this->getId()) {
+            throw new InvalidArgumentException("Cannot copy an object to itself");
+        }
+
+        $size = $this->stat()->getSize();
+        if ($size === 0) {
+            $target->writeFull("");
+            return $this;
+        }
+
+        /** @var Buffer[] $buffers */
+        $buffers = [];
+        /** @var array{int, Buffer, ReadCompletion}[] $reads */
+        $reads = [];
+        /** @var WriteCompletion[] $writes */
+        $writes = [];
+        $offset = 0;
+        try {
+            while ($offset < $size || count($reads) > 0) {
+                while (count($reads) < $concurrency && $offset < $size) {
+                    $length = min($chunkSize, $size - $offset);
+                    $buffer = array_pop($buffers) ?? Buffer::create($this->getIOContext()->getFFI(), min($chunkSize, $size));
+                    $reads[] = [$offset, $buffer, $this->readAsync($length, $offset, $buffer)];
+                    $offset += $length;
+                }
+
+                [$chunkOffset, $buffer, $completion] = array_shift($reads);
+                $readLength = RadosObjectException::handle($completion->waitForComplete()->getReturnValue());
+                $view = $buffer->view(0, $readLength);
+                $writes[] = $chunkOffset === 0 ? $target->writeFullAsync($view) : $target->writeAsync($view, $chunkOffset);
+                $buffers[] = $buffer;
+
+                while (count($writes) > $concurrency) {
+                    array_shift($writes)->waitAndGetResult();
+                }
+            }
+
+            while (count($writes) > 0) {
+                array_shift($writes)->waitAndGetResult();
+            }
+        } finally {
+            foreach ($reads as [, , $completion]) {
+                $completion->waitForComplete();
+            }
+            foreach ($writes as $write) {
+                $write->waitForComplete();
+            }
+        }
+        return $this;
+    }
+
+    /**
+     * Upload a local file into this object, replacing its content
+     *
+     * The file is mapped into memory with mmap and the mapped chunks are passed directly to async writes,
+     * so the data is never copied into PHP strings. If the file cannot be mapped, it is read with pread
+     * into a reused buffer instead. An allocation hint with the file size is set before the first write.
+     *
+     * @param string $path - path of the local file
+     * @param int $chunkSize - maximum number of bytes per write
+     * @param int $concurrency - maximum number of writes in flight
+     * @return $this
+     * @throws RadosException
+     */
+    public function uploadFile(string $path, int $chunkSize = self::TRANSFER_CHUNK_SIZE, int $concurrency = self::TRANSFER_CONCURRENCY): static
+    {
+        if ($chunkSize < 1 || $concurrency < 1) {
+            throw new InvalidArgumentException("Chunk size and concurrency must be positive");
+        }
+
+        $file = LocalFile::open(Rados::getInstance()->getLibC(), $path, LocalFile::O_RDONLY);
+        $size = $file->getSize();
+        if ($size === 0) {
+            $this->writeFull("");
+            return $this;
+        }
+        $this->setAllocHint($size, min($chunkSize, $size), [AllocHintFlag::SequentialWrite]);
+
+        $map = $file->map($size);
+        $buffer = null;
+        /** @var WriteCompletion[] $writes */
+        $writes = [];
+        try {
+            for ($offset = 0; $offset < $size; $offset += $chunkSize) {
+                $length = min($chunkSize, $size - $offset);
+                if ($map !== null) {
+                    $data = $map->view($offset, $length);
+                } else {
+                    $buffer ??= Buffer::create($this->getIOContext()->getFFI(), min($chunkSize, $size));
+                    $data = $buffer->view(0, $file->read($buffer, $length, $offset));
+                }
+
+                $writes[] = $offset === 0 ? $this->writeFullAsync($data) : $this->writeAsync($data, $offset);
+                while (count($writes) >= $concurrency) {
+                    array_shift($writes)->waitAndGetResult();
+                }
+            }
+            foreach ($writes as $write) {
+                $write->waitAndGetResult();
+            }
+        } finally {
+            foreach ($writes as $write) {
+                $write->waitForComplete();
+            }
+            $map?->release();
+            $file->close();
+        }
+        return $this;
+    }
+
+    /**
+     * Download this object into a local file, replacing its content
+     *
+     * The file is resized to the size of the object and mapped into memory with mmap,
+     * async reads write directly into the mapped chunks, so the data is never copied into PHP strings.
+     * If the file cannot be mapped, the data is read into reused buffers and written with pwrite instead.
+     *
+     * @param string $path - path of the local file, created if it does not exist
+     * @param int $chunkSize - maximum number of bytes per read
+     * @param int $concurrency - maximum number of reads in flight
+     * @return $this
+     * @throws RadosException
+     */
+    public function downloadFile(string $path, int $chunkSize = self::TRANSFER_CHUNK_SIZE, int $concurrency = self::TRANSFER_CONCURRENCY): static
+    {
+        if ($chunkSize < 1 || $concurrency < 1) {
+            throw new InvalidArgumentException("Chunk size and concurrency must be positive");
+        }
+
+        $size = $this->stat()->getSize();
+        $file = LocalFile::open(Rados::getInstance()->getLibC(), $path,
+            LocalFile::O_RDWR | LocalFile::O_CREAT | LocalFile::O_TRUNC);
+        if ($size === 0) {
+            $file->close();
+            return $this;
+        }
+        $file->truncate($size);
+
+        $map = $file->map($size, true);
+        /** @var Buffer[] $buffers */
+        $buffers = [];
+        /** @var array{int, int, Buffer|null, ReadCompletion}[] $reads */
+        $reads = [];
+        $end = $size;
+        try {
+            $offset = 0;
+            while ($offset < $size || count($reads) > 0) {
+                while (count($reads) < $concurrency && $offset < $size) {
+                    $length = min($chunkSize, $size - $offset);
+                    if ($map !== null) {
+                        $buffer = null;
+                        $target = $map->view($offset, $length);
+                    } else {
+                        $buffer = array_pop($buffers) ?? Buffer::create($this->getIOContext()->getFFI(), min($chunkSize, $size));
+                        $target = $buffer;
+                    }
+                    $reads[] = [$offset, $length, $buffer, $this->readAsync($length, $offset, $target)];
+                    $offset += $length;
+                }
+
+                [$chunkOffset, $length, $buffer, $completion] = array_shift($reads);
+                $readLength = RadosObjectException::handle($completion->waitForComplete()->getReturnValue());
+                if ($readLength < $length) {
+                    $end = min($end, $chunkOffset + $readLength);
+                }
+                if ($buffer !== null) {
+                    $file->write($buffer->view(0, $readLength), $chunkOffset);
+                    $buffers[] = $buffer;
+                }
+            }
+        } finally {
+            foreach ($reads as [, , , $completion]) {
+                $completion->waitForComplete();
+            }
+            $map?->release();
+        }
+
+        if ($end < $size) {
+            $file->truncate($end);
+        }
+        $file->close();
+        return $this;
+    }
+
     /**
      * Binding for rados_checksum
      * Compute checksum from object data
@@ -679,67 +924,86 @@ class RadosObject
      *
      * @param int $length
      * @param int $offset
-     * @param Buffer|null $readBuffer
+     * @param Buffer|BufferView|null $readBuffer - buffer or buffer view to read into,
+     *  the number of bytes read is the return value of the completion
      * @return ReadCompletion
      * @throws RadosException
      * @noinspection PhpUndefinedMethodInspection
      */
-    public function readAsync(int $length, int $offset, ?Buffer $readBuffer = null): ReadCompletion
+    public function readAsync(int $length, int $offset, Buffer|BufferView|null $readBuffer = null): ReadCompletion
     {
-        if ($readBuffer !== null && $readBuffer->getSize() >= $length) {
-            $buffer = $readBuffer;
-        } else {
-            $buffer = Buffer::create($this->getIOContext()->getFFI(), $length);
-        }
+        $this->getIOContext()->acquireThrottle($length);
+        try {
+            if ($readBuffer !== null && BufferView::length($readBuffer) >= $length) {
+                $buffer = $readBuffer;
+            } else {
+                $buffer = Buffer::create($this->getIOContext()->getFFI(), $length);
+            }
 
-        $completion = new ReadCompletion($buffer, $this->getIOContext());
-        RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_read(
-            $this->getIOContext()->getCData(), $this->getId(),
-            $completion->getCData(), $buffer->getCData(),
-            $length, $offset
-        ));
-        return $completion;
+            $completion = new ReadCompletion($buffer, $this->getIOContext());
+            RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_read(
+                $this->getIOContext()->getCData(), $this->getId(),
+                $completion->getCData(), BufferView::pointer($buffer),
+                $length, $offset
+            ));
+        } catch (Throwable $e) {
+            $this->getIOContext()->releaseThrottle($length);
+            throw $e;
+        }
+        return $this->getIOContext()->trackThrottled($completion);
     }
 
     /**
      * Binding for rados_aio_write
      * Write data to an object asynchronously
      *
-     * @param string $buffer - data to write
+     * @param string|Buffer|BufferView $buffer - data to write
      * @param int $offset - offset to start writing at
      * @return WriteCompletion
      * @throws RadosException
      * @noinspection PhpUndefinedMethodInspection
      */
-    public function writeAsync(string $buffer, int $offset): WriteCompletion
+    public function writeAsync(string|Buffer|BufferView $buffer, int $offset): WriteCompletion
     {
-        $completion = new WriteCompletion($this->getIOContext());
-        RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_write(
-            $this->getIOContext()->getCData(), $this->getId(),
-            $completion->getCData(), $buffer,
-            strlen($buffer), $offset
-        ));
-        return $completion;
+        $this->getIOContext()->acquireThrottle(BufferView::length($buffer));
+        try {
+            $completion = new WriteCompletion($this->getIOContext());
+            RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_write(
+                $this->getIOContext()->getCData(), $this->getId(),
+                $completion->getCData(), BufferView::pointer($buffer),
+                BufferView::length($buffer), $offset
+            ));
+        } catch (Throwable $e) {
+            $this->getIOContext()->releaseThrottle(BufferView::length($buffer));
+            throw $e;
+        }
+        return $this->getIOContext()->trackThrottled($completion);
     }
 
     /**
      * Binding for rados_aio_append
      * Asynchronously append data to an object
      *
-     * @param string $buffer - data to append
+     * @param string|Buffer|BufferView $buffer - data to append
      * @return WriteCompletion
      * @throws RadosException
      * @noinspection PhpUndefinedMethodInspection
      */
-    public function appendAsync(string $buffer): WriteCompletion
+    public function appendAsync(string|Buffer|BufferView $buffer): WriteCompletion
     {
-        $completion = new WriteCompletion($this->getIOContext());
-        RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_append(
-            $this->getIOContext()->getCData(), $this->getId(),
-            $completion->getCData(),
-            $buffer, strlen($buffer)
-        ));
-        return $completion;
+        $this->getIOContext()->acquireThrottle(BufferView::length($buffer));
+        try {
+            $completion = new WriteCompletion($this->getIOContext());
+            RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_append(
+                $this->getIOContext()->getCData(), $this->getId(),
+                $completion->getCData(),
+                BufferView::pointer($buffer), BufferView::length($buffer)
+            ));
+        } catch (Throwable $e) {
+            $this->getIOContext()->releaseThrottle(BufferView::length($buffer));
+            throw $e;
+        }
+        return $this->getIOContext()->trackThrottled($completion);
     }
 
     /**
@@ -749,20 +1013,26 @@ class RadosObject
      * The object is filled with the provided data. If the object exists,
      * it is atomically truncated and then written.
      *
-     * @param string $buffer - data to write
+     * @param string|Buffer|BufferView $buffer - data to write
      * @return WriteCompletion
      * @throws RadosException
      * @noinspection PhpUndefinedMethodInspection
      */
-    public function writeFullAsync(string $buffer): WriteCompletion
+    public function writeFullAsync(string|Buffer|BufferView $buffer): WriteCompletion
     {
-        $completion = new WriteCompletion($this->getIOContext());
-        RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_write_full(
-            $this->getIOContext()->getCData(), $this->getId(),
-            $completion->getCData(),
-            $buffer, strlen($buffer)
-        ));
-        return $completion;
+        $this->getIOContext()->acquireThrottle(BufferView::length($buffer));
+        try {
+            $completion = new WriteCompletion($this->getIOContext());
+            RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_write_full(
+                $this->getIOContext()->getCData(), $this->getId(),
+                $completion->getCData(),
+                BufferView::pointer($buffer), BufferView::length($buffer)
+            ));
+        } catch (Throwable $e) {
+            $this->getIOContext()->releaseThrottle(BufferView::length($buffer));
+            throw $e;
+        }
+        return $this->getIOContext()->trackThrottled($completion);
     }
 
     /**
@@ -780,14 +1050,20 @@ class RadosObject
      */
     public function writeSameAsync(string $buffer, int $writeLength, int $offset): WriteCompletion
     {
-        $completion = new WriteCompletion($this->getIOContext());
-        RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_writesame(
-            $this->getIOContext()->getCData(), $this->getId(),
-            $completion->getCData(),
-            $buffer, strlen($buffer),
-            $writeLength, $offset
-        ));
-        return $completion;
+        $this->getIOContext()->acquireThrottle($writeLength);
+        try {
+            $completion = new WriteCompletion($this->getIOContext());
+            RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_writesame(
+                $this->getIOContext()->getCData(), $this->getId(),
+                $completion->getCData(),
+                $buffer, strlen($buffer),
+                $writeLength, $offset
+            ));
+        } catch (Throwable $e) {
+            $this->getIOContext()->releaseThrottle($writeLength);
+            throw $e;
+        }
+        return $this->getIOContext()->trackThrottled($completion);
     }
 
     /**
@@ -800,12 +1076,18 @@ class RadosObject
      */
     public function removeAsync(): RemoveCompletion
     {
-        $completion = new RemoveCompletion($this->getIOContext());
-        RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_remove(
-            $this->getIOContext()->getCData(), $this->getId(),
-            $completion->getCData()
-        ));
-        return $completion;
+        $this->getIOContext()->acquireThrottle();
+        try {
+            $completion = new RemoveCompletion($this->getIOContext());
+            RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_remove(
+                $this->getIOContext()->getCData(), $this->getId(),
+                $completion->getCData()
+            ));
+        } catch (Throwable $e) {
+            $this->getIOContext()->releaseThrottle();
+            throw $e;
+        }
+        return $this->getIOContext()->trackThrottled($completion);
     }
 
     /**
@@ -818,15 +1100,21 @@ class RadosObject
      */
     public function statAsync(): StatCompletion
     {
-        $size = $this->getIOContext()->getFFI()->new("uint64_t");
-        $mtime = $this->getIOContext()->getFFI()->new("struct timespec");
-        $completion = new StatCompletion($size, $mtime, $this->getIOContext());
-        RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_stat2(
-            $this->getIOContext()->getCData(), $this->getId(),
-            $completion->getCData(),
-            FFI::addr($size), FFI::addr($mtime)
-        ));
-        return $completion;
+        $this->getIOContext()->acquireThrottle();
+        try {
+            $size = $this->getIOContext()->getFFI()->new("uint64_t");
+            $mtime = $this->getIOContext()->getFFI()->new("struct timespec");
+            $completion = new StatCompletion($size, $mtime, $this->getIOContext());
+            RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_stat2(
+                $this->getIOContext()->getCData(), $this->getId(),
+                $completion->getCData(),
+                FFI::addr($size), FFI::addr($mtime)
+            ));
+        } catch (Throwable $e) {
+            $this->getIOContext()->releaseThrottle();
+            throw $e;
+        }
+        return $this->getIOContext()->trackThrottled($completion);
     }
 
     /**
@@ -841,13 +1129,19 @@ class RadosObject
      */
     public function compareExtAsync(string $compare, int $offset): CompareCompletion
     {
-        $completion = new CompareCompletion($this->getIOContext());
-        RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_cmpext(
-            $this->getIOContext()->getCData(), $this->getId(),
-            $completion->getCData(),
-            $compare, strlen($compare), $offset
-        ));
-        return $completion;
+        $this->getIOContext()->acquireThrottle(strlen($compare));
+        try {
+            $completion = new CompareCompletion($this->getIOContext());
+            RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_cmpext(
+                $this->getIOContext()->getCData(), $this->getId(),
+                $completion->getCData(),
+                $compare, strlen($compare), $offset
+            ));
+        } catch (Throwable $e) {
+            $this->getIOContext()->releaseThrottle(strlen($compare));
+            throw $e;
+        }
+        return $this->getIOContext()->trackThrottled($completion);
     }
 
     /**
@@ -862,14 +1156,20 @@ class RadosObject
      */
     public function getXAttributeAsync(string $name, int $maxLength): GetXAttributeCompletion
     {
-        $buffer = Buffer::create($this->getIOContext()->getFFI(), $maxLength);
-        $completion = new GetXAttributeCompletion($buffer, $this->getIOContext());
-        RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_getxattr(
-            $this->getIOContext()->getCData(), $this->getId(),
-            $completion->getCData(),
-            $name, $buffer->getCData(), $maxLength
-        ));
-        return $completion;
+        $this->getIOContext()->acquireThrottle($maxLength);
+        try {
+            $buffer = Buffer::create($this->getIOContext()->getFFI(), $maxLength);
+            $completion = new GetXAttributeCompletion($buffer, $this->getIOContext());
+            RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_getxattr(
+                $this->getIOContext()->getCData(), $this->getId(),
+                $completion->getCData(),
+                $name, $buffer->getCData(), $maxLength
+            ));
+        } catch (Throwable $e) {
+            $this->getIOContext()->releaseThrottle($maxLength);
+            throw $e;
+        }
+        return $this->getIOContext()->trackThrottled($completion);
     }
 
     /**
@@ -883,13 +1183,19 @@ class RadosObject
      */
     public function setXAttributeAsync(string $name, string $value): SetXAttributeCompletion
     {
-        $completion = new SetXAttributeCompletion($this->getIOContext());
-        RadosException::handle($this->getIOContext()->getFFI()->rados_aio_setxattr(
-            $this->getIOContext()->getCData(), $this->getId(),
-            $completion->getCData(),
-            $name, $value, strlen($value)
-        ));
-        return $completion;
+        $this->getIOContext()->acquireThrottle(strlen($value));
+        try {
+            $completion = new SetXAttributeCompletion($this->getIOContext());
+            RadosException::handle($this->getIOContext()->getFFI()->rados_aio_setxattr(
+                $this->getIOContext()->getCData(), $this->getId(),
+                $completion->getCData(),
+                $name, $value, strlen($value)
+            ));
+        } catch (Throwable $e) {
+            $this->getIOContext()->releaseThrottle(strlen($value));
+            throw $e;
+        }
+        return $this->getIOContext()->trackThrottled($completion);
     }
 
     /**
@@ -902,12 +1208,18 @@ class RadosObject
      */
     public function removeXAttributeAsync(string $name): RemoveXAttributeCompletion
     {
-        $completion = new RemoveXAttributeCompletion($this->getIOContext());
-        RadosException::handle($this->getIOContext()->getFFI()->rados_aio_rmxattr(
-            $this->getIOContext()->getCData(), $this->getId(),
-            $completion->getCData(), $name
-        ));
-        return $completion;
+        $this->getIOContext()->acquireThrottle();
+        try {
+            $completion = new RemoveXAttributeCompletion($this->getIOContext());
+            RadosException::handle($this->getIOContext()->getFFI()->rados_aio_rmxattr(
+                $this->getIOContext()->getCData(), $this->getId(),
+                $completion->getCData(), $name
+            ));
+        } catch (Throwable $e) {
+            $this->getIOContext()->releaseThrottle();
+            throw $e;
+        }
+        return $this->getIOContext()->trackThrottled($completion);
     }
 
     /**
@@ -919,17 +1231,22 @@ class RadosObject
      */
     public function getXAttributesAsync(): GetXAttributesCompletion
     {
-        $ffi = $this->getIOContext()->getFFI();
-        $iterator = $ffi->new('rados_xattrs_iter_t');
-        $completion = new GetXAttributesCompletion($iterator, $this->getIOContext());
-        RadosObjectException::handle($ffi->rados_aio_getxattrs(
-            $this->getIOContext()->getCData(),
-            $this->getId(),
-            $completion->getCData(),
-            FFI::addr($iterator)
-        ));
-
-        return $completion;
+        $this->getIOContext()->acquireThrottle();
+        try {
+            $ffi = $this->getIOContext()->getFFI();
+            $iterator = $ffi->new('rados_xattrs_iter_t');
+            $completion = new GetXAttributesCompletion($iterator, $this->getIOContext());
+            RadosObjectException::handle($ffi->rados_aio_getxattrs(
+                $this->getIOContext()->getCData(),
+                $this->getId(),
+                $completion->getCData(),
+                FFI::addr($iterator)
+            ));
+        } catch (Throwable $e) {
+            $this->getIOContext()->releaseThrottle();
+            throw $e;
+        }
+        return $this->getIOContext()->trackThrottled($completion);
     }
 
     /**
@@ -953,21 +1270,26 @@ class RadosObject
      */
     public function executeAsync(string $class, string $method, string $input, int $maxOutputSize, ?Buffer $outputBuffer = null): OsdClassMethodExecuteCompletion
     {
-        if ($outputBuffer !== null && $outputBuffer->getSize() >= $maxOutputSize) {
-            $buffer = $outputBuffer;
-        } else {
-            $buffer = Buffer::create($this->getIOContext()->getFFI(), $maxOutputSize);
+        $this->getIOContext()->acquireThrottle(strlen($input) + $maxOutputSize);
+        try {
+            if ($outputBuffer !== null && $outputBuffer->getSize() >= $maxOutputSize) {
+                $buffer = $outputBuffer;
+            } else {
+                $buffer = Buffer::create($this->getIOContext()->getFFI(), $maxOutputSize);
+            }
+            $completion = new OsdClassMethodExecuteCompletion($buffer, $this->getIOContext());
+            RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_exec(
+                $this->getIOContext()->getCData(),
+                $this->getId(),
+                $completion->getCData(),
+                $class, $method,
+                $input, strlen($input),
+                $buffer->getCData(), $maxOutputSize
+            ));
+        } catch (Throwable $e) {
+            $this->getIOContext()->releaseThrottle(strlen($input) + $maxOutputSize);
+            throw $e;
         }
-        $completion = new OsdClassMethodExecuteCompletion($buffer, $this->getIOContext());
-        RadosObjectException::handle($this->getIOContext()->getFFI()->rados_aio_exec(
-            $this->getIOContext()->getCData(),
-            $this->getId(),
-            $completion->getCData(),
-            $class, $method,
-            $input, strlen($input),
-            $buffer->getCData(), $maxOutputSize
-        ));
-
-        return $completion;
+        return $this->getIOContext()->trackThrottled($completion);
     }
 }
@@ -0,0 +1,307 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Throttle;
+
+use Aternos\Rados\Completion\Completion;
+use Aternos\Rados\Exception\RadosException;
+use InvalidArgumentException;
+use WeakReference;
+
+/**
+ * Client-side throttle for asynchronous operations
+ *
+ * Limits the rate of operations and bytes using token buckets, as well as the number of operations in flight.
+ * Submissions that exceed a limit block until they are admitted.
+ * A throttle can be shared by multiple IOContexts, each using its own priority.
+ * While operations of a higher priority are waiting or in flight, lower priorities can only use
+ * a part of the limits, otherwise every priority can use the full limits.
+ */
+class Throttle
+{
+    protected ?TokenBucket $operationBucket = null;
+    protected ?TokenBucket $byteBucket = null;
+
+    /**
+     * @var array{WeakReference<Completion>, ThrottlePriority}[]
+     */
+    protected array $inFlight = [];
+
+    /**
+     * @var array<string, int> - admitted operations that have not been submitted yet, by priority
+     */
+    protected array $admittedCount = [];
+
+    /**
+     * @var array<string, int>
+     */
+    protected array $waitingCount = [];
+
+    /**
+     * @var array<string, int>
+     */
+    protected array $throttledCount = [];
+
+    /**
+     * @var array<string, float>
+     */
+    protected array $throttledTime = [];
+
+    /**
+     * @param float|null $operationsPerSecond - maximum operations per second, null for no limit
+     * @param float|null $bytesPerSecond - maximum bytes per second, null for no limit
+     * @param int|null $maxInFlight - maximum number of operations in flight, null for no limit
+     * @param float|null $operationBurst - burst size in operations, defaults to one second worth of operations
+     * @param float|null $byteBurst - burst size in bytes, defaults to one second worth of bytes
+     */
+    public function __construct(
+        ?float $operationsPerSecond = null,
+        ?float $bytesPerSecond = null,
+        protected ?int $maxInFlight = null,
+        ?float $operationBurst = null,
+        ?float $byteBurst = null
+    )
+    {
+        if ($operationsPerSecond !== null) {
+            $this->operationBucket = new TokenBucket($operationsPerSecond, $operationBurst);
+        }
+        if ($bytesPerSecond !== null) {
+            $this->byteBucket = new TokenBucket($bytesPerSecond, $byteBurst);
+        }
+        if ($this->maxInFlight !== null && $this->maxInFlight < 1) {
+            throw new InvalidArgumentException("Maximum in-flight count must be at least 1");
+        }
+    }
+
+    /**
+     * Block until an operation of $bytes bytes is admitted and take its tokens
+     *
+     * @param int $bytes - payload size of the operation
+     * @param ThrottlePriority $priority
+     * @return $this
+     * @throws RadosException
+     * @internal Called by async operations before submitting them
+     */
+    public function acquire(int $bytes, ThrottlePriority $priority = ThrottlePriority::Normal): static
+    {
+        $start = hrtime(true);
+        $throttled = false;
+
+        $this->waitingCount[$priority->name] = ($this->waitingCount[$priority->name] ?? 0) + 1;
+        try {
+            while (true) {
+                $this->reap();
+                $reserved = $this->getReservedFraction($priority);
+                if ($this->maxInFlight !== null && $this->countInFlight() >= $this->getInFlightLimit($reserved)) {
+                    $throttled = true;
+                    reset($this->inFlight);
+                    current($this->inFlight)[0]->get()?->waitForComplete();
+                    continue;
+                }
+
+                $wait = max(
+                    $this->operationBucket?->getWaitTime(1, $reserved) ?? 0.0,
+                    $this->byteBucket?->getWaitTime($bytes, $reserved) ?? 0.0
+                );
+                if ($wait <= 0) {
+                    break;
+                }
+                $throttled = true;
+                usleep((int)max(1, ceil($wait * 1e6)));
+            }
+        } finally {
+            $this->waitingCount[$priority->name]--;
+        }
+
+        $this->operationBucket?->consume(1);
+        $this->byteBucket?->consume($bytes);
+        $this->admittedCount[$priority->name] = ($this->admittedCount[$priority->name] ?? 0) + 1;
+        if ($throttled) {
+            $this->throttledCount[$priority->name] = ($this->throttledCount[$priority->name] ?? 0) + 1;
+            $this->throttledTime[$priority->name] = ($this->throttledTime[$priority->name] ?? 0.0) + (hrtime(true) - $start) / 1e9;
+        }
+        return $this;
+    }
+
+    /**
+     * Track a submitted operation for the in-flight limit
+     *
+     * @param Completion $completion
+     * @param ThrottlePriority $priority - priority the operation was admitted with
+     * @return $this
+     * @internal Called by async operations after submitting them
+     */
+    public function track(Completion $completion, ThrottlePriority $priority = ThrottlePriority::Normal): static
+    {
+        $this->removeAdmitted($priority);
+        $this->inFlight[] = [WeakReference::create($completion), $priority];
+        return $this;
+    }
+
+    /**
+     * Give back the tokens and the in-flight slot of an admitted operation that could not be submitted
+     *
+     * @param int $bytes - payload size the operation was admitted with
+     * @param ThrottlePriority $priority - priority the operation was admitted with
+     * @return $this
+     * @internal Called by async operations if submitting them failed
+     */
+    public function release(int $bytes, ThrottlePriority $priority = ThrottlePriority::Normal): static
+    {
+        $this->removeAdmitted($priority);
+        $this->operationBucket?->refund(1);
+        $this->byteBucket?->refund($bytes);
+        return $this;
+    }
+
+    /**
+     * Get the number of tracked operations that have not completed yet
+     *
+     * @return int
+     * @throws RadosException
+     */
+    public function getInFlightCount(): int
+    {
+        $this->reap();
+        return $this->countInFlight();
+    }
+
+    /**
+     * @return int|null
+     */
+    public function getMaxInFlight(): ?int
+    {
+        return $this->maxInFlight;
+    }
+
+    /**
+     * Get the current operation tokens, null if operations are not limited
+     *
+     * @return float|null
+     */
+    public function getOperationTokens(): ?float
+    {
+        return $this->operationBucket?->getTokens();
+    }
+
+    /**
+     * Get the current byte tokens, null if bytes are not limited
+     *
+     * @return float|null
+     */
+    public function getByteTokens(): ?float
+    {
+        return $this->byteBucket?->getTokens();
+    }
+
+    /**
+     * Get the number of submissions currently waiting to be admitted
+     *
+     * @param ThrottlePriority|null $priority - null for all priorities
+     * @return int
+     */
+    public function getWaitingCount(?ThrottlePriority $priority = null): int
+    {
+        if ($priority === null) {
+            return array_sum($this->waitingCount);
+        }
+        return $this->waitingCount[$priority->name] ?? 0;
+    }
+
+    /**
+     * Get the number of submissions that had to wait before being admitted
+     *
+     * @param ThrottlePriority|null $priority - null for all priorities
+     * @return int
+     */
+    public function getThrottledCount(?ThrottlePriority $priority = null): int
+    {
+        if ($priority === null) {
+            return array_sum($this->throttledCount);
+        }
+        return $this->throttledCount[$priority->name] ?? 0;
+    }
+
+    /**
+     * Get the total time in seconds submissions waited before being admitted
+     *
+     * @param ThrottlePriority|null $priority - null for all priorities
+     * @return float
+     */
+    public function getThrottledTime(?ThrottlePriority $priority = null): float
+    {
+        if ($priority === null) {
+            return array_sum($this->throttledTime);
+        }
+        return $this->throttledTime[$priority->name] ?? 0.0;
+    }
+
+    /**
+     * Get the fraction of the limits that is currently reserved for priorities higher than $priority
+     *
+     * @param ThrottlePriority $priority
+     * @return float
+     */
+    protected function getReservedFraction(ThrottlePriority $priority): float
+    {
+        foreach (ThrottlePriority::cases() as $other) {
+            if (!$other->isHigherThan($priority)) {
+                continue;
+            }
+            if (($this->waitingCount[$other->name] ?? 0) > 0 || ($this->admittedCount[$other->name] ?? 0) > 0) {
+                return $priority->getReservedFraction();
+            }
+        }
+        foreach ($this->inFlight as [, $other]) {
+            if ($other->isHigherThan($priority)) {
+                return $priority->getReservedFraction();
+            }
+        }
+        return 0.0;
+    }
+
+    /**
+     * @param float $reservedFraction
+     * @return int
+     */
+    protected function getInFlightLimit(float $reservedFraction): int
+    {
+        return max(1, (int)floor($this->maxInFlight * (1 - $reservedFraction)));
+    }
+
+    /**
+     * Count tracked operations and admitted operations that have not been submitted yet
+     *
+     * @return int
+     */
+    protected function countInFlight(): int
+    {
+        return count($this->inFlight) + array_sum($this->admittedCount);
+    }
+
+    /**
+     * @param ThrottlePriority $priority
+     * @return void
+     */
+    protected function removeAdmitted(ThrottlePriority $priority): void
+    {
+        if (($this->admittedCount[$priority->name] ?? 0) > 0) {
+            $this->admittedCount[$priority->name]--;
+        }
+    }
+
+    /**
+     * Remove completed and destroyed operations from the in-flight list
+     *
+     * @return void
+     * @throws RadosException
+     */
+    protected function reap(): void
+    {
+        foreach ($this->inFlight as $i => [$reference]) {
+            $completion = $reference->get();
+            if ($completion === null || !$completion->isValid() || $completion->isComplete()) {
+                unset($this->inFlight[$i]);
+            }
+        }
+    }
+}
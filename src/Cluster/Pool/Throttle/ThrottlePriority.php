@@ -0,0 +1,51 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Throttle;
+
+/**
+ * Priority class of submissions to a throttle
+ *
+ * While operations of higher priorities are waiting or in flight, lower priorities can only use
+ * a part of the token bucket capacity and in-flight limit, the remaining part is reserved for the higher priorities.
+ */
+enum ThrottlePriority
+{
+    case High;
+    case Normal;
+    case Low;
+
+    /**
+     * Get the fraction of the throttle limits reserved for higher priorities
+     *
+     * @return float
+     */
+    public function getReservedFraction(): float
+    {
+        return match ($this) {
+            ThrottlePriority::High => 0.0,
+            ThrottlePriority::Normal => 0.25,
+            ThrottlePriority::Low => 0.5,
+        };
+    }
+
+    /**
+     * @param ThrottlePriority $other
+     * @return bool
+     */
+    public function isHigherThan(ThrottlePriority $other): bool
+    {
+        return $this->getLevel() > $other->getLevel();
+    }
+
+    /**
+     * @return int
+     */
+    public function getLevel(): int
+    {
+        return match ($this) {
+            ThrottlePriority::High => 2,
+            ThrottlePriority::Normal => 1,
+            ThrottlePriority::Low => 0,
+        };
+    }
+}
@@ -0,0 +1,113 @@
+<?php
+
+namespace Aternos\Rados\Cluster\Pool\Throttle;
+
+use InvalidArgumentException;
+
+class TokenBucket
+{
+    protected float $tokens;
+    protected int $lastRefill;
+
+    /**
+     * @param float $rate - tokens added per second
+     * @param float|null $capacity - maximum number of tokens (burst size), defaults to one second worth of tokens
+     */
+    public function __construct(protected float $rate, protected ?float $capacity = null)
+    {
+        if ($this->rate <= 0) {
+            throw new InvalidArgumentException("Rate must be greater than 0");
+        }
+        $this->capacity ??= $this->rate;
+        if ($this->capacity <= 0) {
+            throw new InvalidArgumentException("Capacity must be greater than 0");
+        }
+        $this->tokens = $this->capacity;
+        $this->lastRefill = hrtime(true);
+    }
+
+    /**
+     * @return float
+     */
+    public function getRate(): float
+    {
+        return $this->rate;
+    }
+
+    /**
+     * @return float
+     */
+    public function getCapacity(): float
+    {
+        return $this->capacity;
+    }
+
+    /**
+     * Get the current number of tokens
+     * The value is negative if a request larger than the capacity was admitted.
+     *
+     * @return float
+     */
+    public function getTokens(): float
+    {
+        $this->refill();
+        return $this->tokens;
+    }
+
+    /**
+     * Get the time until $amount tokens can be consumed
+     *
+     * Requests larger than the capacity are admitted once the bucket is full,
+     * the missing tokens are taken as debt.
+     *
+     * @param float $amount
+     * @param float $reservedFraction - fraction of the capacity that has to remain available
+     * @return float - time in seconds, 0 if the tokens are available now
+     */
+    public function getWaitTime(float $amount, float $reservedFraction = 0.0): float
+    {
+        $this->refill();
+        $reserved = $this->capacity * $reservedFraction;
+        $required = min($amount, $this->capacity - $reserved) + $reserved;
+        if ($this->tokens >= $required) {
+            return 0.0;
+        }
+        return ($required - $this->tokens) / $this->rate;
+    }
+
+    /**
+     * Take tokens from the bucket
+     *
+     * @param float $amount
+     * @return $this
+     */
+    public function consume(float $amount): static
+    {
+        $this->refill();
+        $this->tokens -= $amount;
+        return $this;
+    }
+
+    /**
+     * Return tokens that were taken for a request that was not executed
+     *
+     * @param float $amount
+     * @return $this
+     */
+    public function refund(float $amount): static
+    {
+        $this->refill();
+        $this->tokens = min($this->capacity, $this->tokens + $amount);
+        return $this;
+    }
+
+    /**
+     * @return void
+     */
+    protected function refill(): void
+    {
+        $now = hrtime(true);
+        $this->tokens = min($this->capacity, $this->tokens + ($now - $this->lastRefill) / 1e9 * $this->rate);
+        $this->lastRefill = $now;
+    }
+}
@@ -8,6 +8,12 @@ use FFI;
 
 class Completion extends WrappedType
 {
+    /**
+     * Initial and maximum polling interval in microseconds used when waiting with a timeout
+     */
+    const POLL_MIN_INTERVAL = 20;
+    const POLL_MAX_INTERVAL = 1000;
+
     /**
      * Binding for rados_aio_create_completion2
      * Constructs a completion to use with asynchronous operations
@@ -40,6 +46,29 @@ class Completion extends WrappedType
         return $this;
     }
 
+    /**
+     * Block until an operation completes or the timeout expires
+     * librados does not provide a timed wait, so the completion is polled with increasing intervals.
+     *
+     * @param float $timeout - timeout in seconds
+     * @return bool - true if the operation completed, false if the timeout expired
+     * @throws RadosException
+     */
+    public function waitForCompleteWithTimeout(float $timeout): bool
+    {
+        $deadline = hrtime(true) + (int)($timeout * 1e9);
+        $interval = static::POLL_MIN_INTERVAL;
+        while (!$this->isComplete()) {
+            $remaining = $deadline - hrtime(true);
+            if ($remaining <= 0) {
+                return false;
+            }
+            usleep((int)max(1, min($interval, $remaining / 1000)));
+            $interval = min($interval * 2, static::POLL_MAX_INTERVAL);
+        }
+        return true;
+    }
+
     /**
      * Binding for rados_aio_wait_for_complete
      * Block until an operation is safe
@@ -4,7 +4,9 @@ namespace Aternos\Rados\Completion;
 
 use Aternos\Rados\Cluster\Pool\IOContext;
 use Aternos\Rados\Exception\CompletionException;
+use Aternos\Rados\Exception\CompletionTimeoutException;
 use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Generated\Errno;
 
 /**
  * @template T
@@ -63,12 +65,34 @@ abstract class ResultCompletion extends Completion
     }
 
     /**
+     * Wait for the operation to complete and get its result
+     * If the timeout expires, the operation is cancelled and a CompletionTimeoutException is thrown
+     * once librados has finished the cancelled operation.
+     *
+     * @param float|null $timeout - timeout in seconds, null to wait indefinitely
      * @return T
      * @throws RadosException
      */
-    public function waitAndGetResult()
+    public function waitAndGetResult(?float $timeout = null)
     {
-        $this->waitForComplete();
+        $policy = $this->ioContext->getLatencyPolicy();
+        if ($timeout === null) {
+            $this->waitForComplete();
+        } else if (!$this->waitForCompleteWithTimeout($timeout)) {
+            try {
+                $this->cancel();
+            } catch (RadosException $e) {
+                if (!$this->isComplete()) {
+                    throw $e;
+                }
+            }
+            // The operation may still write into its result buffers until librados has finished it
+            $this->waitForComplete();
+            if ($this->getReturnValue() === -Errno::ECANCELED->value) {
+                $policy?->recordTimeout();
+                throw CompletionTimeoutException::create();
+            }
+        }
         return $this->getResult();
     }
 
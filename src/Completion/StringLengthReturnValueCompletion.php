@@ -6,6 +6,7 @@ use Aternos\Rados\Cluster\Pool\IOContext;
 use Aternos\Rados\Exception\CompletionException;
 use Aternos\Rados\Exception\RadosException;
 use Aternos\Rados\Util\Buffer\Buffer;
+use Aternos\Rados\Util\Buffer\BufferView;
 
 /**
  * @extends ResultCompletion<string>
@@ -13,11 +14,11 @@ use Aternos\Rados\Util\Buffer\Buffer;
 class StringLengthReturnValueCompletion extends ResultCompletion
 {
     /**
-     * @param Buffer $buffer
+     * @param Buffer|BufferView $buffer
      * @param IOContext $ioContext
      * @internal Completions are returned from async operations and should not be created manually
      */
-    public function __construct(protected Buffer $buffer, IOContext $ioContext)
+    public function __construct(protected Buffer|BufferView $buffer, IOContext $ioContext)
     {
         parent::__construct($ioContext);
     }
@@ -0,0 +1,16 @@
+<?php
+
+namespace Aternos\Rados\Exception;
+
+use Aternos\Rados\Generated\Errno;
+
+class CompletionTimeoutException extends CompletionException
+{
+    /**
+     * @return static
+     */
+    public static function create(): static
+    {
+        return static::fromErrorCode(-Errno::ETIMEDOUT->value);
+    }
+}
@@ -0,0 +1,10 @@
+<?php
+
+namespace Aternos\Rados\Exception;
+
+use Aternos\Rados\Exception\RadosException;
+
+class LogException extends RadosException
+{
+
+}
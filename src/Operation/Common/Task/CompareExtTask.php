@@ -49,7 +49,7 @@ class CompareExtTask extends CommonOperationTask
      */
     protected function initTask(Operation $operation): void
     {
-        $this->result = $operation->getFFI()->new('int');
+        $this->result ??= $operation->getFFI()->new('int');
         $operation->getFFI()->{$this->getFunctionName($operation)}(
             $operation->getCData(),
             $this->buffer,
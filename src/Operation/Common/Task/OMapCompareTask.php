@@ -50,7 +50,7 @@ class OMapCompareTask extends CommonOperationTask
      */
     protected function initTask(Operation $operation): void
     {
-        $this->result = $operation->getFFI()->new('int');
+        $this->result ??= $operation->getFFI()->new('int');
         $operation->getFFI()->{$this->getFunctionName($operation)}(
             $operation->getCData(),
             $this->key,
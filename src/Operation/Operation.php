@@ -5,6 +5,7 @@ namespace Aternos\Rados\Operation;
 use Aternos\Rados\Cluster\Pool\Object\RadosObject;
 use Aternos\Rados\Completion\OperationCompletion;
 use Aternos\Rados\Constants\OperationFlag;
+use Aternos\Rados\Exception\RadosException;
 use Aternos\Rados\Util\TimeSpec;
 use Aternos\Rados\Util\WrappedType;
 
@@ -48,6 +49,39 @@ abstract class Operation extends WrappedType
      */
     abstract public function operateAsync(RadosObject $object, ?TimeSpec $mtime = null, array $flags = []): OperationCompletion;
 
+    /**
+     * Perform the operation asynchronously and wait for it with a deadline
+     * If the timeout expires, the operation is cancelled and a CompletionTimeoutException is thrown.
+     *
+     * @note A cancelled write operation may still have been applied by the OSD
+     *
+     * @param RadosObject $object
+     * @param float|null $timeout - timeout in seconds, defaults to the timeout of the IOContext's latency policy
+     * @param TimeSpec|null $mtime
+     * @param OperationFlag[] $flags
+     * @return OperationTask[]
+     * @throws RadosException
+     */
+    public function operateWithTimeout(RadosObject $object, ?float $timeout = null, ?TimeSpec $mtime = null, array $flags = []): array
+    {
+        $timeout ??= $object->getIOContext()->getLatencyPolicy()?->getTimeout();
+        return $this->operateAsync($object, $mtime, $flags)->waitAndGetResult($timeout);
+    }
+
+    /**
+     * Get the number of data bytes transferred by all tasks, used for throttling
+     *
+     * @return int
+     */
+    public function getPayloadLength(): int
+    {
+        $length = 0;
+        foreach ($this->tasks as $task) {
+            $length += $task->getPayloadLength();
+        }
+        return $length;
+    }
+
     /**
      * @return OperationTask[]
      */
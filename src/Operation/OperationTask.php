@@ -61,6 +61,21 @@ abstract class OperationTask
         return $this;
     }
 
+    /**
+     * Detach this task from its operation, so it can be appended to a new one
+     * Allocated result slots and buffers are kept and reused when the task is appended again
+     *
+     * @return $this
+     * @internal Used by PreparedOperation to reuse tasks, results of the previous execution are discarded
+     */
+    public final function detach(): static
+    {
+        $this->operation = null;
+        $this->parsedResult = null;
+        $this->resultParsed = false;
+        return $this;
+    }
+
     /**
      * @param Operation $operation
      * @return void
@@ -82,6 +97,16 @@ abstract class OperationTask
         return $this;
     }
 
+    /**
+     * Get the number of data bytes transferred by this task, used for throttling
+     *
+     * @return int
+     */
+    public function getPayloadLength(): int
+    {
+        return 0;
+    }
+
     public function getFlags(): array
     {
         return $this->flags;
@@ -0,0 +1,229 @@
+<?php
+
+namespace Aternos\Rados\Operation\Prepared;
+
+use Aternos\Rados\Cluster\Pool\Object\RadosObject;
+use Aternos\Rados\Completion\OperationCompletion;
+use Aternos\Rados\Constants\OperationFlag;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Operation\Operation;
+use Aternos\Rados\Operation\OperationTask;
+use Aternos\Rados\Util\TimeSpec;
+use Closure;
+use FFI;
+use Generator;
+use InvalidArgumentException;
+use Throwable;
+
+/**
+ * An operation template that can be executed on many objects
+ *
+ * The task list is created once per execution slot by the task factory.
+ * Result slots and buffers allocated by the tasks are reused for every execution
+ * that uses the same slot, so only the object, mtime and flags are bound at execution time.
+ *
+ * @note Task results are only valid until their slot is reused by another execution
+ */
+abstract class PreparedOperation
+{
+    /**
+     * @var OperationTask[][]
+     */
+    protected array $freeSlots = [];
+
+    /**
+     * @var array<int, array{OperationCompletion, OperationTask[]}>
+     */
+    protected array $pendingSlots = [];
+
+    /**
+     * @var OperationTask[]|null
+     */
+    protected ?array $syncSlot = null;
+    protected int $slotCount = 0;
+
+    /**
+     * @param FFI $ffi
+     * @param Closure(): OperationTask[] $taskFactory - creates a new list of tasks for the operation
+     * @internal Use Rados::createPreparedReadOperation or Rados::createPreparedWriteOperation instead
+     */
+    public function __construct(protected FFI $ffi, protected Closure $taskFactory)
+    {
+    }
+
+    /**
+     * Create a new, empty operation
+     *
+     * @return Operation
+     */
+    abstract protected function createOperation(): Operation;
+
+    /**
+     * Perform the operation synchronously
+     *
+     * @note The returned tasks are reused by the next synchronous execution
+     *
+     * @param RadosObject $object
+     * @param TimeSpec|null $mtime
+     * @param OperationFlag[] $flags
+     * @return OperationTask[]
+     * @throws RadosException
+     */
+    public function operate(RadosObject $object, ?TimeSpec $mtime = null, array $flags = []): array
+    {
+        $this->syncSlot ??= $this->createSlot();
+        return $this->bind($this->syncSlot)->operate($object, $mtime, $flags);
+    }
+
+    /**
+     * Perform the operation asynchronously
+     *
+     * The slot used by this execution becomes available again once the completion is passed to recycle().
+     * The completion is referenced until then, so librados never writes into a reused slot. If no free slot
+     * is left, completed executions that were not recycled are reclaimed by later executions,
+     * so their results should be read before starting more executions.
+     *
+     * @param RadosObject $object
+     * @param TimeSpec|null $mtime
+     * @param OperationFlag[] $flags
+     * @return OperationCompletion
+     * @throws RadosException
+     */
+    public function operateAsync(RadosObject $object, ?TimeSpec $mtime = null, array $flags = []): OperationCompletion
+    {
+        $tasks = $this->acquireSlot();
+        try {
+            $completion = $this->bind($tasks)->operateAsync($object, $mtime, $flags);
+        } catch (Throwable $e) {
+            $this->freeSlots[] = $tasks;
+            throw $e;
+        }
+
+        $this->pendingSlots[spl_object_id($completion)] = [$completion, $tasks];
+        return $completion;
+    }
+
+    /**
+     * Perform the operation on many objects, keeping up to $concurrency executions in flight
+     *
+     * Completed executions are yielded in submission order with the object as key.
+     * Their slot is recycled as soon as the generator is resumed, so results have to be
+     * read before requesting the next one.
+     *
+     * @param iterable<RadosObject> $objects
+     * @param int $concurrency - maximum number of executions in flight
+     * @param TimeSpec|null $mtime
+     * @param OperationFlag[] $flags
+     * @return Generator<RadosObject, OperationCompletion>
+     * @throws RadosException
+     */
+    public function operatePipelined(iterable $objects, int $concurrency = 16, ?TimeSpec $mtime = null, array $flags = []): Generator
+    {
+        if ($concurrency < 1) {
+            throw new InvalidArgumentException("Concurrency must be at least 1");
+        }
+
+        /** @var array{RadosObject, OperationCompletion}[] $inFlight */
+        $inFlight = [];
+        try {
+            foreach ($objects as $object) {
+                if (count($inFlight) >= $concurrency) {
+                    [$done, $completion] = array_shift($inFlight);
+                    yield $done => $completion->waitForComplete();
+                    $this->recycle($completion);
+                }
+                $inFlight[] = [$object, $this->operateAsync($object, $mtime, $flags)];
+            }
+
+            while (count($inFlight) > 0) {
+                [$done, $completion] = array_shift($inFlight);
+                yield $done => $completion->waitForComplete();
+                $this->recycle($completion);
+            }
+        } finally {
+            foreach ($inFlight as [, $completion]) {
+                $this->recycle($completion);
+            }
+        }
+    }
+
+    /**
+     * Return the slot of a completed asynchronous execution to the pool
+     * Waits for the execution to complete if necessary.
+     *
+     * @note Results of the tasks of this completion must not be used after recycling it
+     *
+     * @param OperationCompletion $completion
+     * @return $this
+     * @throws RadosException
+     */
+    public function recycle(OperationCompletion $completion): static
+    {
+        $id = spl_object_id($completion);
+        if (!isset($this->pendingSlots[$id]) || $this->pendingSlots[$id][0] !== $completion) {
+            throw new InvalidArgumentException("Completion was not created by this prepared operation");
+        }
+
+        $completion->waitForComplete();
+        $this->freeSlots[] = $this->pendingSlots[$id][1];
+        unset($this->pendingSlots[$id]);
+        return $this;
+    }
+
+    /**
+     * Get the number of task lists allocated by this prepared operation
+     *
+     * @return int
+     */
+    public function getSlotCount(): int
+    {
+        return $this->slotCount;
+    }
+
+    /**
+     * @return OperationTask[]
+     */
+    protected function acquireSlot(): array
+    {
+        if (count($this->freeSlots) === 0) {
+            foreach ($this->pendingSlots as $id => [$completion, $tasks]) {
+                if ($completion->isComplete()) {
+                    $this->freeSlots[] = $tasks;
+                    unset($this->pendingSlots[$id]);
+                }
+            }
+        }
+
+        return array_pop($this->freeSlots) ?? $this->createSlot();
+    }
+
+    /**
+     * @return OperationTask[]
+     */
+    protected function createSlot(): array
+    {
+        $tasks = array_values(($this->taskFactory)());
+        foreach ($tasks as $task) {
+            if (!($task instanceof OperationTask)) {
+                throw new InvalidArgumentException("Task factory must return an array of OperationTask objects");
+            }
+        }
+        $this->slotCount++;
+        return $tasks;
+    }
+
+    /**
+     * Append the tasks of a slot to a new operation
+     *
+     * @param OperationTask[] $tasks
+     * @return Operation
+     */
+    protected function bind(array $tasks): Operation
+    {
+        $operation = $this->createOperation();
+        foreach ($tasks as $task) {
+            $operation->addTask($task->detach());
+        }
+        return $operation;
+    }
+}
@@ -0,0 +1,45 @@
+<?php
+
+namespace Aternos\Rados\Operation\Prepared;
+
+use Aternos\Rados\Cluster\Pool\Latency\LatencyPolicy;
+use Aternos\Rados\Cluster\Pool\Object\RadosObject;
+use Aternos\Rados\Completion\OperationCompletion;
+use Aternos\Rados\Constants\OperationFlag;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Operation\Read\ReadOperation;
+
+class PreparedReadOperation extends PreparedOperation
+{
+    /**
+     * @inheritDoc
+     */
+    protected function createOperation(): ReadOperation
+    {
+        return ReadOperation::create($this->ffi);
+    }
+
+    /**
+     * Perform the operation as hedged read
+     *
+     * If the operation does not complete within the hedge delay of the latency policy,
+     * it is issued a second time with the hedge flags of the policy. The first execution
+     * to complete is returned, see LatencyPolicy::executeHedged for the other one.
+     * The slot of the other execution is recycled after it has completed or, if it was cancelled,
+     * after librados has finished it.
+     *
+     * @param RadosObject $object
+     * @param LatencyPolicy|null $policy - defaults to the latency policy of the object's IOContext
+     * @param OperationFlag[] $flags
+     * @return OperationCompletion - the completed execution
+     * @throws RadosException
+     */
+    public function operateHedged(RadosObject $object, ?LatencyPolicy $policy = null, array $flags = []): OperationCompletion
+    {
+        $policy ??= $object->getIOContext()->getLatencyPolicy() ?? new LatencyPolicy();
+        return $policy->executeHedged(
+            fn(array $hedgeFlags) => $this->operateAsync($object, null, array_merge($flags, $hedgeFlags)),
+            fn(OperationCompletion $completion) => $this->recycle($completion)
+        );
+    }
+}
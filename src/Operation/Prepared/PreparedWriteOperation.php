@@ -0,0 +1,16 @@
+<?php
+
+namespace Aternos\Rados\Operation\Prepared;
+
+use Aternos\Rados\Operation\Write\WriteOperation;
+
+class PreparedWriteOperation extends PreparedOperation
+{
+    /**
+     * @inheritDoc
+     */
+    protected function createOperation(): WriteOperation
+    {
+        return WriteOperation::create($this->ffi);
+    }
+}
@@ -11,6 +11,7 @@ use Aternos\Rados\Operation\Operation;
 use Aternos\Rados\Util\TimeSpec;
 use FFI;
 use RuntimeException;
+use Throwable;
 
 class ReadOperation extends Operation
 {
@@ -64,20 +65,25 @@ class ReadOperation extends Operation
             throw new RuntimeException("Operation was already executed");
         }
 
-        $flagsValue = OperationFlag::combine($this->ffi, ...$flags);
-        $completion = new OperationCompletion($this->getTasks(), $object->getIOContext());
-
-        RadosObjectException::handle($this->ffi->rados_aio_read_op_operate(
-            $this->getCData(),
-            $object->getIOContext()->getCData(),
-            $completion->getCData(),
-            $object->getId(),
-            $flagsValue
-        ));
+        $object->getIOContext()->acquireThrottle($this->getPayloadLength());
+        try {
+            $flagsValue = OperationFlag::combine($this->ffi, ...$flags);
+            $completion = new OperationCompletion($this->getTasks(), $object->getIOContext());
 
-        $this->executed = true;
+            RadosObjectException::handle($this->ffi->rados_aio_read_op_operate(
+                $this->getCData(),
+                $object->getIOContext()->getCData(),
+                $completion->getCData(),
+                $object->getId(),
+                $flagsValue
+            ));
 
-        return $completion;
+            $this->executed = true;
+        } catch (Throwable $e) {
+            $object->getIOContext()->releaseThrottle($this->getPayloadLength());
+            throw $e;
+        }
+        return $object->getIOContext()->trackThrottled($completion);
     }
 
     /**
@@ -66,15 +66,17 @@ class ChecksumTask extends ReadOperationTask
      */
     protected function initTask(Operation $operation): void
     {
-        $this->result = $operation->getFFI()->new('int');
+        $this->result ??= $operation->getFFI()->new('int');
 
         $checksumLength = $this->type->getLength();
         $initString = $this->type->createInitString($this->initValue);
 
         $resultCount = ceil($this->length / $this->chunkSize);
-        $resultLength = $resultCount * $checksumLength + 4;
+        $resultLength = (int)($resultCount * $checksumLength + 4);
 
-        $this->buffer = Buffer::create($operation->getFFI(), $resultLength);
+        if ($this->buffer === null || $this->buffer->getSize() !== $resultLength) {
+            $this->buffer = Buffer::create($operation->getFFI(), $resultLength);
+        }
 
         $operation->getFFI()->rados_read_op_checksum(
             $operation->getCData(),
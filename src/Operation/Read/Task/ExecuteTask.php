@@ -61,9 +61,9 @@ class ExecuteTask extends WriteOperationTask
      */
     protected function initTask(Operation $operation): void
     {
-        $this->result = $operation->getFFI()->new('int');
-        $this->output = $operation->getFFI()->new('char*');
-        $this->outputLength = $operation->getFFI()->new('size_t');
+        $this->result ??= $operation->getFFI()->new('int');
+        $this->output ??= $operation->getFFI()->new('char*');
+        $this->outputLength ??= $operation->getFFI()->new('size_t');
 
         if ($this->outputBuffer !== null) {
             $operation->getFFI()->rados_read_op_exec_user_buf(
@@ -38,7 +38,7 @@ class GetXAttributesTask extends ReadOperationTask
      */
     protected function initTask(Operation $operation): void
     {
-        $this->result = $operation->getFFI()->new('int');
+        $this->result ??= $operation->getFFI()->new('int');
         $this->iterator = $operation->getFFI()->new('rados_xattrs_iter_t');
 
         $operation->getFFI()->rados_read_op_getxattrs(
@@ -23,6 +23,8 @@ class OMapGetByKeysTask extends ReadOperationTask
 {
     protected ?CData $result = null;
     protected ?CData $iterator = null;
+    protected ?CData $keyLengths = null;
+    protected ?StringArray $keyArray = null;
 
     /**
      * @param string[] $keys
@@ -62,26 +64,27 @@ class OMapGetByKeysTask extends ReadOperationTask
     protected function initTask(Operation $operation): void
     {
         $ffi = $operation->getFFI();
-        $this->result = $ffi->new('int');
+        $this->result ??= $ffi->new('int');
         $this->iterator = $ffi->new('rados_omap_iter_t');
 
         $count = count($this->keys);
-        $keyLengths = $ffi->new(FFI::arrayType($ffi->type('size_t'), [$count]));
-        $keyEntries = [];
-        $i = 0;
-        foreach ($this->keys as $key) {
-            $keyEntries[$i] = $key;
-            $keyLengths[$i] = strlen($key);
-            $i++;
+        if ($this->keyArray === null) {
+            $this->keyLengths = $ffi->new(FFI::arrayType($ffi->type('size_t'), [$count]));
+            $keyEntries = [];
+            $i = 0;
+            foreach ($this->keys as $key) {
+                $keyEntries[$i] = $key;
+                $this->keyLengths[$i] = strlen($key);
+                $i++;
+            }
+            $this->keyArray = new StringArray($keyEntries, $ffi);
         }
 
-        $keys = new StringArray($keyEntries, $operation->getFFI());
-
         $operation->getFFI()->rados_read_op_omap_get_vals_by_keys2(
             $operation->getCData(),
-            $keys->getCData(),
+            $this->keyArray->getCData(),
             $count,
-            $keyLengths,
+            $this->keyLengths,
             FFI::addr($this->iterator),
             FFI::addr($this->result)
         );
@@ -59,9 +59,9 @@ class OMapGetTask extends ReadOperationTask
      */
     protected function initTask(Operation $operation): void
     {
-        $this->result = $operation->getFFI()->new('int');
+        $this->result ??= $operation->getFFI()->new('int');
         $this->iterator = $operation->getFFI()->new('rados_omap_iter_t');
-        $this->hasMore = $operation->getFFI()->new('uint8_t');
+        $this->hasMore ??= $operation->getFFI()->new('uint8_t');
 
         $operation->getFFI()->rados_read_op_omap_get_vals2(
             $operation->getCData(),
@@ -32,6 +32,14 @@ class ReadTask extends ReadOperationTask
     {
     }
 
+    /**
+     * @inheritDoc
+     */
+    public function getPayloadLength(): int
+    {
+        return $this->length;
+    }
+
     /**
      * @inheritDoc
      * @throws RadosException
@@ -51,8 +59,8 @@ class ReadTask extends ReadOperationTask
      */
     protected function initTask(Operation $operation): void
     {
-        $this->result = $operation->getFFI()->new('int');
-        $this->bytesRead = $operation->getFFI()->new('size_t');
+        $this->result ??= $operation->getFFI()->new('int');
+        $this->bytesRead ??= $operation->getFFI()->new('size_t');
 
         if ($this->readBuffer === null || $this->readBuffer->getSize() < $this->length) {
             $this->readBuffer = Buffer::create($operation->getFFI(), $this->length);
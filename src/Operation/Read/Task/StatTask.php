@@ -43,9 +43,9 @@ class StatTask extends ReadOperationTask
      */
     protected function initTask(Operation $operation): void
     {
-        $this->result = $operation->getFFI()->new('int');
-        $this->size = $operation->getFFI()->new('uint64_t');
-        $this->mTime = $operation->getFFI()->new('struct timespec');
+        $this->result ??= $operation->getFFI()->new('int');
+        $this->size ??= $operation->getFFI()->new('uint64_t');
+        $this->mTime ??= $operation->getFFI()->new('struct timespec');
 
         $operation->getFFI()->rados_read_op_stat2(
             $operation->getCData(),
@@ -44,7 +44,7 @@ class ExecuteTask extends WriteOperationTask
      */
     protected function initTask(Operation $operation): void
     {
-        $this->result = $operation->getFFI()->new('int');
+        $this->result ??= $operation->getFFI()->new('int');
         $operation->getFFI()->rados_write_op_exec(
             $operation->getCData(),
             $this->class,
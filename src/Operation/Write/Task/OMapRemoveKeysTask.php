@@ -6,6 +6,7 @@ use Aternos\Rados\Operation\Operation;
 use Aternos\Rados\Operation\Write\WriteOperationTask;
 use Aternos\Rados\Util\StringArray;
 use FFI;
+use FFI\CData;
 use InvalidArgumentException;
 
 /**
@@ -15,6 +16,9 @@ use InvalidArgumentException;
  */
 class OMapRemoveKeysTask extends WriteOperationTask
 {
+    protected ?CData $keyLengths = null;
+    protected ?StringArray $keyArray = null;
+
     /**
      * @param string[] $keys
      */
@@ -45,21 +49,22 @@ class OMapRemoveKeysTask extends WriteOperationTask
     {
         $ffi = $operation->getFFI();
         $count = count($this->keys);
-        $keyLengths = $ffi->new(FFI::arrayType($ffi->type('size_t'), [$count]));
-        $keyEntries = [];
-        $i = 0;
-        foreach ($this->keys as $key) {
-            $keyEntries[$i] = $key;
-            $keyLengths[$i] = strlen($key);
-            $i++;
+        if ($this->keyArray === null) {
+            $this->keyLengths = $ffi->new(FFI::arrayType($ffi->type('size_t'), [$count]));
+            $keyEntries = [];
+            $i = 0;
+            foreach ($this->keys as $key) {
+                $keyEntries[$i] = $key;
+                $this->keyLengths[$i] = strlen($key);
+                $i++;
+            }
+            $this->keyArray = new StringArray($keyEntries, $ffi);
         }
 
-        $keys = new StringArray($keyEntries, $operation->getFFI());
-
         $operation->getFFI()->rados_write_op_omap_rm_keys2(
             $operation->getCData(),
-            $keys->getCData(),
-            $keyLengths,
+            $this->keyArray->getCData(),
+            $this->keyLengths,
             $count
         );
     }
@@ -6,6 +6,7 @@ use Aternos\Rados\Operation\Operation;
 use Aternos\Rados\Operation\Write\WriteOperationTask;
 use Aternos\Rados\Util\StringArray;
 use FFI;
+use FFI\CData;
 
 /**
  * Set key/value pairs on an object
@@ -14,6 +15,11 @@ use FFI;
  */
 class OMapSetTask extends WriteOperationTask
 {
+    protected ?CData $keyLengths = null;
+    protected ?CData $valueLengths = null;
+    protected ?StringArray $keyArray = null;
+    protected ?StringArray $valueArray = null;
+
     /**
      * @param string[] $values - associative array of key-value pairs
      */
@@ -39,28 +45,29 @@ class OMapSetTask extends WriteOperationTask
     {
         $ffi = $operation->getFFI();
         $count = count($this->values);
-        $keyLengths = $ffi->new(FFI::arrayType($ffi->type('size_t'), [$count]));
-        $valueLengths = $ffi->new(FFI::arrayType($ffi->type('size_t'), [$count]));
-        $keyEntries = [];
-        $valueEntries = [];
-        $i = 0;
-        foreach ($this->values as $key => $value) {
-            $keyEntries[$i] = $key;
-            $valueEntries[$i] = $value;
-            $keyLengths[$i] = strlen($key);
-            $valueLengths[$i] = strlen($value);
-            $i++;
+        if ($this->keyArray === null) {
+            $this->keyLengths = $ffi->new(FFI::arrayType($ffi->type('size_t'), [$count]));
+            $this->valueLengths = $ffi->new(FFI::arrayType($ffi->type('size_t'), [$count]));
+            $keyEntries = [];
+            $valueEntries = [];
+            $i = 0;
+            foreach ($this->values as $key => $value) {
+                $keyEntries[$i] = (string)$key;
+                $valueEntries[$i] = $value;
+                $this->keyLengths[$i] = strlen($key);
+                $this->valueLengths[$i] = strlen($value);
+                $i++;
+            }
+            $this->keyArray = new StringArray($keyEntries, $ffi);
+            $this->valueArray = new StringArray($valueEntries, $ffi);
         }
 
-        $keys = new StringArray($keyEntries, $operation->getFFI());
-        $values = new StringArray($valueEntries, $operation->getFFI());
-
         $operation->getFFI()->rados_write_op_omap_set2(
             $operation->getCData(),
-            $keys->getCData(),
-            $values->getCData(),
-            $keyLengths,
-            $valueLengths,
+            $this->keyArray->getCData(),
+            $this->valueArray->getCData(),
+            $this->keyLengths,
+            $this->valueLengths,
             $count
         );
     }
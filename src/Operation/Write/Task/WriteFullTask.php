@@ -4,6 +4,8 @@ namespace Aternos\Rados\Operation\Write\Task;
 
 use Aternos\Rados\Operation\Operation;
 use Aternos\Rados\Operation\Write\WriteOperationTask;
+use Aternos\Rados\Util\Buffer\Buffer;
+use Aternos\Rados\Util\Buffer\BufferView;
 
 /**
  * Write whole object, atomically replacing it.
@@ -13,14 +15,22 @@ use Aternos\Rados\Operation\Write\WriteOperationTask;
 class WriteFullTask extends WriteOperationTask
 {
     /**
-     * @param string $buffer
+     * @param string|Buffer|BufferView $buffer
      */
     public function __construct(
-        protected string $buffer
+        protected string|Buffer|BufferView $buffer
     )
     {
     }
 
+    /**
+     * @inheritDoc
+     */
+    public function getPayloadLength(): int
+    {
+        return BufferView::length($this->buffer);
+    }
+
     /**
      * @inheritDoc
      */
@@ -37,8 +47,8 @@ class WriteFullTask extends WriteOperationTask
     {
         $operation->getFFI()->rados_write_op_write_full(
             $operation->getCData(),
-            $this->buffer,
-            strlen($this->buffer)
+            BufferView::pointer($this->buffer),
+            BufferView::length($this->buffer)
         );
     }
 }
@@ -25,6 +25,14 @@ class WriteSameTask extends WriteOperationTask
     {
     }
 
+    /**
+     * @inheritDoc
+     */
+    public function getPayloadLength(): int
+    {
+        return $this->writeLength;
+    }
+
     /**
      * @inheritDoc
      */
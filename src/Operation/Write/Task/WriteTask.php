@@ -4,6 +4,8 @@ namespace Aternos\Rados\Operation\Write\Task;
 
 use Aternos\Rados\Operation\Operation;
 use Aternos\Rados\Operation\Write\WriteOperationTask;
+use Aternos\Rados\Util\Buffer\Buffer;
+use Aternos\Rados\Util\Buffer\BufferView;
 
 /**
  * Write to offset
@@ -13,16 +15,24 @@ use Aternos\Rados\Operation\Write\WriteOperationTask;
 class WriteTask extends WriteOperationTask
 {
     /**
-     * @param string $buffer
+     * @param string|Buffer|BufferView $buffer
      * @param int $offset
      */
     public function __construct(
-        protected string $buffer,
+        protected string|Buffer|BufferView $buffer,
         protected int $offset
     )
     {
     }
 
+    /**
+     * @inheritDoc
+     */
+    public function getPayloadLength(): int
+    {
+        return BufferView::length($this->buffer);
+    }
+
     /**
      * @inheritDoc
      */
@@ -39,8 +49,8 @@ class WriteTask extends WriteOperationTask
     {
         $operation->getFFI()->rados_write_op_write(
             $operation->getCData(),
-            $this->buffer,
-            strlen($this->buffer),
+            BufferView::pointer($this->buffer),
+            BufferView::length($this->buffer),
             $this->offset
         );
     }
@@ -10,6 +10,7 @@ use Aternos\Rados\Exception\RadosObjectException;
 use Aternos\Rados\Operation\Operation;
 use Aternos\Rados\Util\TimeSpec;
 use FFI;
+use Throwable;
 
 class WriteOperation extends Operation
 {
@@ -54,19 +55,24 @@ class WriteOperation extends Operation
      */
     public function operateAsync(RadosObject $object, ?TimeSpec $mtime = null, array $flags = []): OperationCompletion
     {
-        $flagsValue = OperationFlag::combine($this->ffi, ...$flags);
-        $completion = new OperationCompletion($this->getTasks(), $object->getIOContext());
-
-        RadosObjectException::handle($this->ffi->rados_aio_write_op_operate(
-            $this->getCData(),
-            $object->getIOContext()->getCData(),
-            $completion->getCData(),
-            $object->getId(),
-            $mtime?->getSeconds(),
-            $flagsValue
-        ));
+        $object->getIOContext()->acquireThrottle($this->getPayloadLength());
+        try {
+            $flagsValue = OperationFlag::combine($this->ffi, ...$flags);
+            $completion = new OperationCompletion($this->getTasks(), $object->getIOContext());
 
-        return $completion;
+            RadosObjectException::handle($this->ffi->rados_aio_write_op_operate(
+                $this->getCData(),
+                $object->getIOContext()->getCData(),
+                $completion->getCData(),
+                $object->getId(),
+                $mtime?->getSeconds(),
+                $flagsValue
+            ));
+        } catch (Throwable $e) {
+            $object->getIOContext()->releaseThrottle($this->getPayloadLength());
+            throw $e;
+        }
+        return $object->getIOContext()->trackThrottled($completion);
     }
 
     /**
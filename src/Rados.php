@@ -5,19 +5,27 @@ namespace Aternos\Rados;
 use Aternos\Rados\Cluster\Cluster;
 use Aternos\Rados\Cluster\ClusterConfig;
 use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Operation\OperationTask;
+use Aternos\Rados\Operation\Prepared\PreparedReadOperation;
+use Aternos\Rados\Operation\Prepared\PreparedWriteOperation;
 use Aternos\Rados\Operation\Read\ReadOperation;
 use Aternos\Rados\Operation\Write\WriteOperation;
 use Aternos\Rados\Util\Buffer\Buffer;
+use Closure;
 use FFI;
 
 class Rados
 {
     const DEFAULT_FFI_SCOPE = "PHP_RADOS_FFI";
+    const LIBC_FFI_SCOPE = "PHP_RADOS_FFI_LIBC";
 
     protected static ?Rados $instance = null;
     protected bool $initialized = false;
+    protected bool $preloaded = false;
     protected ?FFI $ffi = null;
+    protected ?FFI $libc = null;
     protected string $headerPath = __DIR__ . "/../includes/librados.h";
+    protected string $libcHeaderPath = __DIR__ . "/../includes/libc.h";
 
     /**
      * @return Rados
@@ -55,6 +63,24 @@ class Rados
         return $this;
     }
 
+    /**
+     * @return string
+     */
+    public function getLibCHeaderPath(): string
+    {
+        return $this->libcHeaderPath;
+    }
+
+    /**
+     * @param string $libcHeaderPath
+     * @return $this
+     */
+    public function setLibCHeaderPath(string $libcHeaderPath): Rados
+    {
+        $this->libcHeaderPath = $libcHeaderPath;
+        return $this;
+    }
+
     /**
      * @return string
      */
@@ -85,6 +111,7 @@ class Rados
     public function preload(): static
     {
         $this->ffi = FFI::load($this->headerPath);
+        $this->libc = FFI::load($this->libcHeaderPath);
         $this->initialized = true;
         return $this;
     }
@@ -106,6 +133,7 @@ class Rados
 
         $this->ffi = FFI::scope(static::DEFAULT_FFI_SCOPE);
         $this->initialized = true;
+        $this->preloaded = true;
         return $this;
     }
 
@@ -194,6 +222,28 @@ class Rados
         return WriteOperation::create($this->ffi);
     }
 
+    /**
+     * Create a reusable read operation
+     *
+     * @param Closure(): OperationTask[] $taskFactory - creates the task list of the operation
+     * @return PreparedReadOperation
+     */
+    public function createPreparedReadOperation(Closure $taskFactory): PreparedReadOperation
+    {
+        return new PreparedReadOperation($this->ffi, $taskFactory);
+    }
+
+    /**
+     * Create a reusable write operation
+     *
+     * @param Closure(): OperationTask[] $taskFactory - creates the task list of the operation
+     * @return PreparedWriteOperation
+     */
+    public function createPreparedWriteOperation(Closure $taskFactory): PreparedWriteOperation
+    {
+        return new PreparedWriteOperation($this->ffi, $taskFactory);
+    }
+
     /**
      * @return ?FFI
      * @internal The FFI context should not be used directly
@@ -202,4 +252,23 @@ class Rados
     {
         return $this->ffi;
     }
+
+    /**
+     * Get the FFI context for the libc functions used for file transfers
+     * The libc headers are loaded on first use, or from the preloaded scope
+     *
+     * @return FFI
+     * @internal The FFI context should not be used directly
+     */
+    public function getLibC(): FFI
+    {
+        if ($this->libc === null) {
+            if ($this->preloaded) {
+                $this->libc = FFI::scope(static::LIBC_FFI_SCOPE);
+            } else {
+                $this->libc = FFI::cdef(file_get_contents($this->libcHeaderPath), "libc.so.6");
+            }
+        }
+        return $this->libc;
+    }
 }
@@ -0,0 +1,183 @@
+<?php
+
+namespace Aternos\Rados\Store\Counter;
+
+use Aternos\Rados\Completion\OperationCompletion;
+use Aternos\Rados\Constants\CreateMode;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Operation\Write\Task\CreateObjectTask;
+use Aternos\Rados\Operation\Write\Task\OMapSetTask;
+use Aternos\Rados\Operation\Write\WriteOperation;
+
+/**
+ * Collects counter updates and executes them with one write operation per object
+ *
+ * All updates of an object are applied atomically and in order by a single operation,
+ * operations for different objects are sent in parallel. Consecutive additions or
+ * multiplications of the same key are combined into one class method call.
+ */
+class CounterBatch
+{
+    const TYPE_ADD = "add";
+    const TYPE_MULTIPLY = "multiply";
+    const TYPE_SET = "set";
+
+    /**
+     * @var array<string, array{string, string, int|float}[]> - updates by object id: type, key, value
+     */
+    protected array $updates = [];
+
+    /**
+     * @var array<string, array<string, int>> - index of the last update of a key by object id and key
+     */
+    protected array $lastUpdate = [];
+
+    /**
+     * @param CounterStore $store
+     * @internal Use CounterStore::createBatch instead
+     */
+    public function __construct(protected CounterStore $store)
+    {
+    }
+
+    /**
+     * Add $delta to a counter, missing counters start at 0
+     *
+     * @param string $objectId
+     * @param string $key
+     * @param int|float $delta
+     * @return $this
+     */
+    public function add(string $objectId, string $key, int|float $delta = 1): static
+    {
+        return $this->addUpdate(static::TYPE_ADD, $objectId, $key, $delta);
+    }
+
+    /**
+     * Multiply a counter by $factor, missing counters are 0
+     *
+     * @param string $objectId
+     * @param string $key
+     * @param int|float $factor
+     * @return $this
+     */
+    public function multiply(string $objectId, string $key, int|float $factor): static
+    {
+        return $this->addUpdate(static::TYPE_MULTIPLY, $objectId, $key, $factor);
+    }
+
+    /**
+     * Set a counter to $value
+     *
+     * @param string $objectId
+     * @param string $key
+     * @param int|float $value
+     * @return $this
+     */
+    public function set(string $objectId, string $key, int|float $value): static
+    {
+        return $this->addUpdate(static::TYPE_SET, $objectId, $key, $value);
+    }
+
+    /**
+     * Get the number of class method calls and omap writes this batch will execute
+     *
+     * @return int
+     */
+    public function getUpdateCount(): int
+    {
+        return array_sum(array_map("count", $this->updates));
+    }
+
+    /**
+     * @return bool
+     */
+    public function isEmpty(): bool
+    {
+        return count($this->updates) === 0;
+    }
+
+    /**
+     * @return $this
+     */
+    public function clear(): static
+    {
+        $this->updates = [];
+        $this->lastUpdate = [];
+        return $this;
+    }
+
+    /**
+     * Execute the batch and wait for all objects
+     *
+     * @return $this
+     * @throws RadosException - the first error, after all operations have completed
+     */
+    public function execute(): static
+    {
+        $exception = null;
+        foreach ($this->executeAsync() as $completion) {
+            try {
+                $completion->waitAndGetResult();
+            } catch (RadosException $e) {
+                $exception ??= $e;
+            }
+        }
+        if ($exception !== null) {
+            throw $exception;
+        }
+        return $this;
+    }
+
+    /**
+     * Send one write operation per object and clear the batch
+     *
+     * @return array<string, OperationCompletion> - completions by object id
+     * @throws RadosException
+     */
+    public function executeAsync(): array
+    {
+        $ioContext = $this->store->getIOContext();
+        $completions = [];
+        foreach ($this->updates as $objectId => $updates) {
+            $objectId = (string)$objectId;
+            $operation = WriteOperation::create($ioContext->getFFI())
+                ->addTask(new CreateObjectTask(CreateMode::Idempotent));
+            foreach ($updates as [$type, $key, $value]) {
+                $operation->addTask(match ($type) {
+                    static::TYPE_ADD => NumOps::createAddTask($key, $value),
+                    static::TYPE_MULTIPLY => NumOps::createMultiplyTask($key, $value),
+                    static::TYPE_SET => new OMapSetTask([$key => NumOps::formatValue($value)]),
+                });
+            }
+            $completions[$objectId] = $operation->operateAsync($ioContext->getObject($objectId));
+        }
+        $this->clear();
+        return $completions;
+    }
+
+    /**
+     * @param string $type
+     * @param string $objectId
+     * @param string $key
+     * @param int|float $value
+     * @return $this
+     */
+    protected function addUpdate(string $type, string $objectId, string $key, int|float $value): static
+    {
+        NumOps::formatValue($value);
+        $index = $this->lastUpdate[$objectId][$key] ?? null;
+        if ($index !== null && $type !== static::TYPE_SET && $this->updates[$objectId][$index][0] === $type) {
+            if ($type === static::TYPE_ADD) {
+                $this->updates[$objectId][$index][2] += $value;
+            } else {
+                $this->updates[$objectId][$index][2] *= $value;
+            }
+            return $this;
+        }
+
+        $this->updates[$objectId][] = [$type, $key, $value];
+        $this->lastUpdate[$objectId][$key] = count($this->updates[$objectId]) - 1;
+        return $this;
+    }
+}
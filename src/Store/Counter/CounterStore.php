@@ -0,0 +1,172 @@
+<?php
+
+namespace Aternos\Rados\Store\Counter;
+
+use Aternos\Rados\Cluster\Pool\IOContext;
+use Aternos\Rados\Completion\OperationCompletion;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Generated\Errno;
+use Aternos\Rados\Operation\Read\ReadOperation;
+use Aternos\Rados\Operation\Read\Task\OMapGetByKeysTask;
+
+/**
+ * Numeric counters stored in omap values, updated atomically on the OSD
+ *
+ * Updates are executed by the numops OSD class, so an increment takes a single round-trip
+ * without reading the current value, locking or retrying on conflicts.
+ * Updates of many counters should be collected in a CounterBatch, which sends one operation per object.
+ *
+ * @note Values are stored by the OSD with 10 significant digits, see NumOps.
+ */
+class CounterStore
+{
+    /**
+     * @param IOContext $ioContext
+     */
+    public function __construct(protected IOContext $ioContext)
+    {
+    }
+
+    /**
+     * @return IOContext
+     */
+    public function getIOContext(): IOContext
+    {
+        return $this->ioContext;
+    }
+
+    /**
+     * @return CounterBatch
+     */
+    public function createBatch(): CounterBatch
+    {
+        return new CounterBatch($this);
+    }
+
+    /**
+     * Add $delta to a counter, missing counters start at 0
+     *
+     * @param string $objectId
+     * @param string $key
+     * @param int|float $delta
+     * @return $this
+     * @throws RadosException
+     */
+    public function increment(string $objectId, string $key, int|float $delta = 1): static
+    {
+        $this->incrementAsync($objectId, $key, $delta)->waitAndGetResult();
+        return $this;
+    }
+
+    /**
+     * @param string $objectId
+     * @param string $key
+     * @param int|float $delta
+     * @return OperationCompletion
+     * @throws RadosException
+     */
+    public function incrementAsync(string $objectId, string $key, int|float $delta = 1): OperationCompletion
+    {
+        return $this->createBatch()->add($objectId, $key, $delta)->executeAsync()[$objectId];
+    }
+
+    /**
+     * Multiply a counter by $factor, missing counters are 0
+     *
+     * @param string $objectId
+     * @param string $key
+     * @param int|float $factor
+     * @return $this
+     * @throws RadosException
+     */
+    public function multiply(string $objectId, string $key, int|float $factor): static
+    {
+        $this->multiplyAsync($objectId, $key, $factor)->waitAndGetResult();
+        return $this;
+    }
+
+    /**
+     * @param string $objectId
+     * @param string $key
+     * @param int|float $factor
+     * @return OperationCompletion
+     * @throws RadosException
+     */
+    public function multiplyAsync(string $objectId, string $key, int|float $factor): OperationCompletion
+    {
+        return $this->createBatch()->multiply($objectId, $key, $factor)->executeAsync()[$objectId];
+    }
+
+    /**
+     * Set a counter to $value
+     *
+     * @param string $objectId
+     * @param string $key
+     * @param int|float $value
+     * @return $this
+     * @throws RadosException
+     */
+    public function set(string $objectId, string $key, int|float $value): static
+    {
+        $this->setAsync($objectId, $key, $value)->waitAndGetResult();
+        return $this;
+    }
+
+    /**
+     * @param string $objectId
+     * @param string $key
+     * @param int|float $value
+     * @return OperationCompletion
+     * @throws RadosException
+     */
+    public function setAsync(string $objectId, string $key, int|float $value): OperationCompletion
+    {
+        return $this->createBatch()->set($objectId, $key, $value)->executeAsync()[$objectId];
+    }
+
+    /**
+     * Get the value of a counter, missing counters are 0
+     *
+     * @param string $objectId
+     * @param string $key
+     * @return int|float
+     * @throws RadosException
+     */
+    public function get(string $objectId, string $key): int|float
+    {
+        return $this->getMany($objectId, [$key])[$key];
+    }
+
+    /**
+     * Get the values of multiple counters of an object with a single read, missing counters are 0
+     *
+     * @param string $objectId
+     * @param string[] $keys
+     * @return array<string, int|float>
+     * @throws RadosException
+     */
+    public function getMany(string $objectId, array $keys): array
+    {
+        $values = array_fill_keys($keys, 0);
+        if (count($keys) === 0) {
+            return $values;
+        }
+
+        $task = new OMapGetByKeysTask($keys);
+        try {
+            ReadOperation::create($this->ioContext->getFFI())
+                ->addTask($task)
+                ->operate($this->ioContext->getObject($objectId));
+        } catch (RadosException $e) {
+            if ($e->is(Errno::ENOENT)) {
+                return $values;
+            }
+            throw $e;
+        }
+
+        foreach ($task->getResult()->getIterator() as $key => $value) {
+            $values[$key] = NumOps::parseValue($value);
+        }
+        return $values;
+    }
+}
@@ -0,0 +1,103 @@
+<?php
+
+namespace Aternos\Rados\Store\Counter;
+
+use Aternos\Rados\Exception\CounterException;
+use Aternos\Rados\Operation\Write\Task\ExecuteTask;
+use InvalidArgumentException;
+
+/**
+ * Encoding for the numops OSD class that ships with Ceph (src/cls/numops)
+ *
+ * The class methods read a numeric omap value, apply an operation and store the result,
+ * atomically on the OSD. Values are stored as decimal strings. The input of a method is the
+ * omap key and the operand, both encoded as Ceph strings (32-bit little-endian length and data).
+ *
+ * @note The OSD formats stored values with 10 significant digits,
+ * so integers with more than 10 digits lose precision.
+ */
+class NumOps
+{
+    const CLASS_NAME = "numops";
+    const METHOD_ADD = "add";
+    const METHOD_MULTIPLY = "mul";
+
+    /**
+     * Create a task that adds $value to the omap value $key, missing values are treated as 0
+     *
+     * @param string $key
+     * @param int|float $value
+     * @return ExecuteTask
+     */
+    public static function createAddTask(string $key, int|float $value): ExecuteTask
+    {
+        return new ExecuteTask(static::CLASS_NAME, static::METHOD_ADD, static::encodeInput($key, $value));
+    }
+
+    /**
+     * Create a task that multiplies the omap value $key by $value, missing values are treated as 0
+     *
+     * @param string $key
+     * @param int|float $value
+     * @return ExecuteTask
+     */
+    public static function createMultiplyTask(string $key, int|float $value): ExecuteTask
+    {
+        return new ExecuteTask(static::CLASS_NAME, static::METHOD_MULTIPLY, static::encodeInput($key, $value));
+    }
+
+    /**
+     * Encode the input of a numops method
+     *
+     * @param string $key
+     * @param int|float $value
+     * @return string
+     */
+    public static function encodeInput(string $key, int|float $value): string
+    {
+        $operand = static::formatValue($value);
+        return pack("V", strlen($key)) . $key . pack("V", strlen($operand)) . $operand;
+    }
+
+    /**
+     * Format a number so that it can be parsed by strtod on the OSD
+     *
+     * @param int|float $value
+     * @return string
+     */
+    public static function formatValue(int|float $value): string
+    {
+        if (is_int($value)) {
+            return (string)$value;
+        }
+        if (!is_finite($value)) {
+            throw new InvalidArgumentException("Counter values must be finite");
+        }
+        return json_encode($value);
+    }
+
+    /**
+     * Parse a value stored by the numops class
+     *
+     * @param string|null $value
+     * @return int|float - integral values are returned as int, missing values as 0
+     * @throws CounterException
+     */
+    public static function parseValue(?string $value): int|float
+    {
+        if ($value === null || $value === "") {
+            return 0;
+        }
+        if (preg_match('/^-?\d+$/', $value) && ($int = filter_var($value, FILTER_VALIDATE_INT)) !== false) {
+            return $int;
+        }
+        if (!is_numeric($value)) {
+            throw new CounterException("Stored counter value " . json_encode($value) . " is not numeric");
+        }
+        $float = (float)$value;
+        if (floor($float) === $float && abs($float) < PHP_INT_MAX) {
+            return (int)$float;
+        }
+        return $float;
+    }
+}
@@ -0,0 +1,96 @@
+<?php
+
+namespace Aternos\Rados\Store\KeyValue;
+
+use InvalidArgumentException;
+
+/**
+ * Maps keys to shards using consistent hashing
+ *
+ * Each shard is placed on the ring multiple times (virtual nodes).
+ * When shards are added, keys only move from existing shards to the new ones.
+ */
+class ConsistentHashRing
+{
+    /**
+     * @var int[]
+     */
+    protected array $points = [];
+
+    /**
+     * @var int[]
+     */
+    protected array $shards = [];
+
+    /**
+     * @param int $shardCount
+     * @param int $virtualNodes - number of points per shard on the ring
+     */
+    public function __construct(protected int $shardCount, protected int $virtualNodes = 64)
+    {
+        if ($this->shardCount < 1) {
+            throw new InvalidArgumentException("Shard count must be at least 1");
+        }
+        if ($this->virtualNodes < 1) {
+            throw new InvalidArgumentException("Virtual node count must be at least 1");
+        }
+
+        $ring = [];
+        for ($shard = 0; $shard < $this->shardCount; $shard++) {
+            for ($node = 0; $node < $this->virtualNodes; $node++) {
+                $point = crc32("shard-" . $shard . "-" . $node);
+                if (!isset($ring[$point])) {
+                    $ring[$point] = $shard;
+                }
+            }
+        }
+        ksort($ring);
+        $this->points = array_keys($ring);
+        $this->shards = array_values($ring);
+    }
+
+    /**
+     * @return int
+     */
+    public function getShardCount(): int
+    {
+        return $this->shardCount;
+    }
+
+    /**
+     * Get the shard a key belongs to
+     *
+     * @param string $key
+     * @return int
+     */
+    public function getShard(string $key): int
+    {
+        $hash = crc32($key);
+        $low = 0;
+        $high = count($this->points);
+        while ($low < $high) {
+            $middle = ($low + $high) >> 1;
+            if ($this->points[$middle] < $hash) {
+                $low = $middle + 1;
+            } else {
+                $high = $middle;
+            }
+        }
+        return $this->shards[$low % count($this->points)];
+    }
+
+    /**
+     * Group keys by their shard
+     *
+     * @param string[] $keys
+     * @return array<int, string[]>
+     */
+    public function groupKeys(array $keys): array
+    {
+        $groups = [];
+        foreach ($keys as $key) {
+            $groups[$this->getShard($key)][] = $key;
+        }
+        return $groups;
+    }
+}
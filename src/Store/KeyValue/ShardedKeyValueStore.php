@@ -0,0 +1,872 @@
+<?php
+
+namespace Aternos\Rados\Store\KeyValue;
+
+use Aternos\Rados\Cluster\Pool\IOContext;
+use Aternos\Rados\Cluster\Pool\Object\RadosObject;
+use Aternos\Rados\Completion\OperationCompletion;
+use Aternos\Rados\Constants\CreateMode;
+use Aternos\Rados\Constants\XAttributeComparisonOperator;
+use Aternos\Rados\Exception\KeyValueStoreException;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Generated\Errno;
+use Aternos\Rados\Operation\Common\Task\CompareXAttributeTask;
+use Aternos\Rados\Operation\Common\Task\OMapCompareTask;
+use Aternos\Rados\Operation\Read\ReadOperation;
+use Aternos\Rados\Operation\Read\Task\OMapGetByKeysTask;
+use Aternos\Rados\Operation\Read\Task\OMapGetTask;
+use Aternos\Rados\Operation\Write\Task\CreateObjectTask;
+use Aternos\Rados\Operation\Write\Task\OMapRemoveKeysTask;
+use Aternos\Rados\Operation\Write\Task\OMapSetTask;
+use Aternos\Rados\Operation\Write\Task\RemoveXAttributeTask;
+use Aternos\Rados\Operation\Write\Task\SetXAttributeTask;
+use Aternos\Rados\Operation\Write\WriteOperation;
+use Closure;
+use Generator;
+use InvalidArgumentException;
+
+/**
+ * Key/value store that distributes keys over the omaps of multiple shard objects
+ *
+ * Keys are assigned to shards using consistent hashing. Batch operations group keys by shard
+ * and submit one operation per shard in parallel.
+ *
+ * The shard count is stored in the extended attributes of a metadata object.
+ * While resharding, writes go to the new shard and reads fall back to the old shard.
+ *
+ * Every change of the shard layout increments an epoch, which is stored in the metadata object
+ * and on every shard object. Writes and getMany() assert the epoch of the shard layout they use
+ * on each shard, so instances that have not noticed a resharding by another instance
+ * reload the layout and retry instead of writing to the wrong shards.
+ *
+ * @note scan() does not check the epoch, call refresh() before scanning if other instances may reshard
+ */
+class ShardedKeyValueStore
+{
+    const SHARD_COUNT_ATTRIBUTE = "kv.shards";
+    const RESHARD_TARGET_ATTRIBUTE = "kv.reshard-target";
+    const EPOCH_ATTRIBUTE = "kv.epoch";
+    const DEFAULT_BATCH_SIZE = 1000;
+    const MAX_LAYOUT_ATTEMPTS = 10;
+
+    protected ConsistentHashRing $ring;
+    protected ?ConsistentHashRing $targetRing = null;
+    protected int $epoch = 0;
+
+    /**
+     * Open a store, creating it with $shardCount shards if it does not exist yet
+     *
+     * @param IOContext $ioContext
+     * @param string $name - name of the store, used as prefix for all objects of the store
+     * @param int $shardCount - shard count for new stores
+     * @return static
+     * @throws RadosException
+     */
+    public static function open(IOContext $ioContext, string $name, int $shardCount = 16): static
+    {
+        $store = new static($ioContext, $name);
+        $store->load($shardCount);
+        return $store;
+    }
+
+    /**
+     * @param IOContext $ioContext
+     * @param string $name
+     * @internal Use ShardedKeyValueStore::open instead
+     */
+    protected function __construct(protected IOContext $ioContext, protected string $name)
+    {
+    }
+
+    /**
+     * @return IOContext
+     */
+    public function getIOContext(): IOContext
+    {
+        return $this->ioContext;
+    }
+
+    /**
+     * @return string
+     */
+    public function getName(): string
+    {
+        return $this->name;
+    }
+
+    /**
+     * @return int
+     */
+    public function getShardCount(): int
+    {
+        return $this->ring->getShardCount();
+    }
+
+    /**
+     * Get the shard count resharding is in progress to, null if no resharding is in progress
+     *
+     * @return int|null
+     */
+    public function getReshardTarget(): ?int
+    {
+        return $this->targetRing?->getShardCount();
+    }
+
+    /**
+     * Get the epoch of the shard layout, incremented by every change of the layout
+     *
+     * @return int
+     */
+    public function getEpoch(): int
+    {
+        return $this->epoch;
+    }
+
+    /**
+     * @return RadosObject
+     */
+    public function getMetadataObject(): RadosObject
+    {
+        return $this->ioContext->getObject($this->name . ".meta");
+    }
+
+    /**
+     * @param int $shard
+     * @return RadosObject
+     */
+    public function getShardObject(int $shard): RadosObject
+    {
+        return $this->ioContext->getObject($this->name . ".shard." . $shard);
+    }
+
+    /**
+     * Reload the shard configuration from the metadata object
+     *
+     * @return $this
+     * @throws RadosException
+     */
+    public function refresh(): static
+    {
+        return $this->load(null);
+    }
+
+    /**
+     * @param string $key
+     * @return string|null
+     * @throws RadosException
+     */
+    public function get(string $key): ?string
+    {
+        return $this->getMany([$key])[$key] ?? null;
+    }
+
+    /**
+     * @param string $key
+     * @param string $value
+     * @return $this
+     * @throws RadosException
+     */
+    public function set(string $key, string $value): static
+    {
+        return $this->setMany([$key => $value]);
+    }
+
+    /**
+     * @param string $key
+     * @return $this
+     * @throws RadosException
+     */
+    public function delete(string $key): static
+    {
+        return $this->deleteMany([$key]);
+    }
+
+    /**
+     * Get the values of multiple keys
+     * Keys that do not exist are not included in the result.
+     *
+     * @param string[] $keys
+     * @return array<string, string>
+     * @throws RadosException
+     */
+    public function getMany(array $keys): array
+    {
+        $keys = $this->normalizeKeys($keys);
+        $values = [];
+        $this->withLayoutGuard(function () use ($keys, &$values) {
+            $ring = $this->targetRing ?? $this->ring;
+            $values = $this->readKeys($ring->groupKeys($keys));
+            if ($values === null) {
+                return false;
+            }
+
+            if ($this->targetRing !== null) {
+                $missing = [];
+                foreach ($keys as $key) {
+                    if (!isset($values[$key]) && $this->ring->getShard($key) !== $ring->getShard($key)) {
+                        $missing[] = $key;
+                    }
+                }
+                $oldValues = $this->readKeys($this->ring->groupKeys($missing));
+                if ($oldValues === null) {
+                    return false;
+                }
+                $values += $oldValues;
+            }
+            return true;
+        });
+        return $values;
+    }
+
+    /**
+     * Set multiple key/value pairs
+     *
+     * @param array<string, string> $values
+     * @return $this
+     * @throws RadosException
+     */
+    public function setMany(array $values): static
+    {
+        $this->withLayoutGuard(function () use ($values) {
+            $ring = $this->targetRing ?? $this->ring;
+            $groups = [];
+            foreach ($values as $key => $value) {
+                $groups[$ring->getShard($key)][(string)$key] = $value;
+            }
+
+            $completions = [];
+            foreach ($groups as $shard => $shardValues) {
+                $completions[] = $this->guardedWriteOperation()
+                    ->addTask(new OMapSetTask($shardValues))
+                    ->operateAsync($this->getShardObject($shard));
+            }
+            if (!$this->waitGuarded($completions)) {
+                return false;
+            }
+
+            return $this->targetRing === null || $this->removeKeys($this->getMovedKeys(array_keys($values)));
+        });
+        return $this;
+    }
+
+    /**
+     * Delete multiple keys
+     *
+     * @param string[] $keys
+     * @return $this
+     * @throws RadosException
+     */
+    public function deleteMany(array $keys): static
+    {
+        $keys = $this->normalizeKeys($keys);
+        $this->withLayoutGuard(function () use ($keys) {
+            if (!$this->removeKeys(($this->targetRing ?? $this->ring)->groupKeys($keys))) {
+                return false;
+            }
+            return $this->targetRing === null || $this->removeKeys($this->getMovedKeys($keys));
+        });
+        return $this;
+    }
+
+    /**
+     * Iterate over all key/value pairs in key order
+     *
+     * The shards are read in pages of $batchSize entries and merged by key.
+     *
+     * @param string|null $startAfter - only return keys after this key
+     * @param string|null $prefix - only return keys starting with this prefix
+     * @param int $batchSize - number of entries to read from a shard at once
+     * @return Generator<string, string>
+     * @throws RadosException
+     */
+    public function scan(?string $startAfter = null, ?string $prefix = null, int $batchSize = self::DEFAULT_BATCH_SIZE): Generator
+    {
+        if ($batchSize < 1) {
+            throw new InvalidArgumentException("Batch size must be at least 1");
+        }
+
+        $ring = $this->targetRing ?? $this->ring;
+        $shardCount = max($this->ring->getShardCount(), $ring->getShardCount());
+
+        /** @var array{entries: array{string, string}[], position: int, more: bool, last: ?string}[] $cursors */
+        $cursors = [];
+        $pending = [];
+        for ($shard = 0; $shard < $shardCount; $shard++) {
+            $pending[$shard] = $this->readPageAsync($shard, $startAfter, $prefix, $batchSize);
+        }
+        foreach ($pending as $shard => [$task, $completion]) {
+            $cursors[$shard] = $this->createCursor($task, $completion, $startAfter);
+        }
+
+        while (true) {
+            $minimum = null;
+            foreach ($cursors as $shard => $cursor) {
+                if ($cursor["position"] >= count($cursor["entries"])) {
+                    if (!$cursor["more"]) {
+                        unset($cursors[$shard]);
+                        continue;
+                    }
+                    [$task, $completion] = $this->readPageAsync($shard, $cursor["last"], $prefix, $batchSize);
+                    $cursors[$shard] = $cursor = $this->createCursor($task, $completion, $cursor["last"]);
+                    if (count($cursor["entries"]) === 0) {
+                        unset($cursors[$shard]);
+                        continue;
+                    }
+                }
+                $key = $cursor["entries"][$cursor["position"]][0];
+                if ($minimum === null || strcmp($key, $minimum) < 0) {
+                    $minimum = $key;
+                }
+            }
+
+            if ($minimum === null) {
+                return;
+            }
+
+            // While resharding, a key can exist on the old and the new shard, the new shard wins
+            $value = null;
+            $owner = $ring->getShard($minimum);
+            foreach ($cursors as $shard => $cursor) {
+                [$key, $entryValue] = $cursor["entries"][$cursor["position"]];
+                if ($key !== $minimum) {
+                    continue;
+                }
+                if ($value === null || $shard === $owner) {
+                    $value = $entryValue;
+                }
+                $cursors[$shard]["position"]++;
+            }
+
+            yield $minimum => $value;
+        }
+    }
+
+    /**
+     * Change the number of shards and move keys to their new shards
+     *
+     * Resharding can be resumed by calling this method again with the same shard count if it was interrupted.
+     * Other instances of this store switch to the new shards with their next write or getMany().
+     *
+     * @note Keys that are deleted while resharding is in progress may be restored if they are moved concurrently.
+     * If resharding to fewer shards is interrupted after it has been completed in the metadata object,
+     * the shard objects that are no longer used are not removed.
+     *
+     * @param int $shardCount
+     * @param int $batchSize - number of entries to move at once
+     * @return $this
+     * @throws RadosException
+     */
+    public function reshard(int $shardCount, int $batchSize = self::DEFAULT_BATCH_SIZE): static
+    {
+        if ($this->targetRing !== null && $this->targetRing->getShardCount() !== $shardCount) {
+            throw new KeyValueStoreException("Resharding to " . $this->targetRing->getShardCount() . " shards is already in progress");
+        }
+        if ($this->targetRing === null) {
+            if ($shardCount === $this->ring->getShardCount()) {
+                return $this;
+            }
+            $this->changeLayout($this->ring->getShardCount(), $shardCount);
+        } else {
+            $this->stampShards();
+        }
+
+        $oldShardCount = $this->ring->getShardCount();
+        for ($shard = 0; $shard < $oldShardCount; $shard++) {
+            $startAfter = null;
+            do {
+                [$task, $completion] = $this->readPageAsync($shard, $startAfter, null, $batchSize);
+                $cursor = $this->createCursor($task, $completion, $startAfter);
+                $startAfter = $cursor["last"];
+
+                $moved = [];
+                foreach ($cursor["entries"] as [$key, $value]) {
+                    if ($this->targetRing->getShard($key) !== $shard) {
+                        $moved[$key] = $value;
+                    }
+                }
+                $this->moveKeys($shard, $moved);
+            } while ($cursor["more"]);
+        }
+
+        $this->changeLayout($shardCount, null);
+
+        // Shards are only removed after the new layout is complete, so they are not recreated by stampShards()
+        $completions = [];
+        for ($shard = $shardCount; $shard < $oldShardCount; $shard++) {
+            $completions[] = $this->getShardObject($shard)->removeAsync();
+        }
+        $this->waitAll($completions, true);
+        return $this;
+    }
+
+    /**
+     * @param int|null $defaultShardCount - create the store with this shard count if it does not exist
+     * @return $this
+     * @throws RadosException
+     */
+    protected function load(?int $defaultShardCount): static
+    {
+        $created = false;
+        try {
+            $attributes = iterator_to_array($this->getMetadataObject()->getXAttributes());
+        } catch (RadosException $e) {
+            if (!$e->is(Errno::ENOENT) || $defaultShardCount === null) {
+                throw $e;
+            }
+            $attributes = $this->create($defaultShardCount);
+            $created = true;
+        }
+
+        if (!isset($attributes[static::SHARD_COUNT_ATTRIBUTE]) || !isset($attributes[static::EPOCH_ATTRIBUTE])) {
+            throw new KeyValueStoreException("Metadata object of store " . $this->name . " is invalid");
+        }
+        $this->setLayout(
+            (int)$attributes[static::SHARD_COUNT_ATTRIBUTE],
+            isset($attributes[static::RESHARD_TARGET_ATTRIBUTE]) ? (int)$attributes[static::RESHARD_TARGET_ATTRIBUTE] : null,
+            (int)$attributes[static::EPOCH_ATTRIBUTE]
+        );
+
+        if ($created) {
+            $this->stampShards();
+        }
+        return $this;
+    }
+
+    /**
+     * @param int $shardCount
+     * @param int|null $target
+     * @param int $epoch
+     * @return void
+     */
+    protected function setLayout(int $shardCount, ?int $target, int $epoch): void
+    {
+        if (!isset($this->ring) || $this->ring->getShardCount() !== $shardCount) {
+            $this->ring = $this->targetRing?->getShardCount() === $shardCount ? $this->targetRing : new ConsistentHashRing($shardCount);
+        }
+        if ($target === null) {
+            $this->targetRing = null;
+        } else if ($this->targetRing?->getShardCount() !== $target) {
+            $this->targetRing = new ConsistentHashRing($target);
+        }
+        $this->epoch = $epoch;
+    }
+
+    /**
+     * Write a new shard layout with the next epoch to the metadata object and stamp the epoch on the shards
+     *
+     * @param int $shardCount
+     * @param int|null $target - shard count resharding is in progress to
+     * @return void
+     * @throws RadosException
+     */
+    protected function changeLayout(int $shardCount, ?int $target): void
+    {
+        $epoch = $this->epoch + 1;
+        $operation = $this->writeOperation()
+            ->addTask(new CompareXAttributeTask(static::EPOCH_ATTRIBUTE, $this->encodeEpoch($this->epoch)))
+            ->addTask(new SetXAttributeTask(static::SHARD_COUNT_ATTRIBUTE, (string)$shardCount))
+            ->addTask(new SetXAttributeTask(static::EPOCH_ATTRIBUTE, $this->encodeEpoch($epoch)));
+        if ($target === null) {
+            $operation->addTask(new RemoveXAttributeTask(static::RESHARD_TARGET_ATTRIBUTE));
+        } else {
+            $operation->addTask(new SetXAttributeTask(static::RESHARD_TARGET_ATTRIBUTE, (string)$target));
+        }
+
+        try {
+            $operation->operate($this->getMetadataObject());
+        } catch (RadosException $e) {
+            if ($e->is(Errno::ECANCELED)) {
+                throw new KeyValueStoreException("Shard layout of store " . $this->name . " was changed concurrently, call refresh() and retry", $e->getCode(), $e);
+            }
+            throw $e;
+        }
+
+        $this->setLayout($shardCount, $target, $epoch);
+        $this->stampShards();
+    }
+
+    /**
+     * Store the current epoch on all shards of the current layout
+     *
+     * Shards that already have the current or a newer epoch are not changed.
+     *
+     * @return void
+     * @throws RadosException
+     */
+    protected function stampShards(): void
+    {
+        $epoch = $this->encodeEpoch($this->epoch);
+        $shards = range(0, max($this->ring->getShardCount(), $this->targetRing?->getShardCount() ?? 0) - 1);
+        while (count($shards) > 0) {
+            $completions = [];
+            foreach ($shards as $shard) {
+                $completions[$shard] = $this->writeOperation()
+                    ->addTask(new CompareXAttributeTask(static::EPOCH_ATTRIBUTE, $epoch, XAttributeComparisonOperator::GreaterThan))
+                    ->addTask(new SetXAttributeTask(static::EPOCH_ATTRIBUTE, $epoch))
+                    ->operateAsync($this->getShardObject($shard));
+            }
+            $missing = [];
+            foreach ($this->waitForErrors($completions) as $shard => $exception) {
+                if ($exception->is(Errno::ENOENT)) {
+                    $missing[] = $shard;
+                } else if (!$exception->is(Errno::ECANCELED)) {
+                    throw $exception;
+                }
+            }
+
+            // New shards are created exclusively, so a newer epoch stamped concurrently is not overwritten
+            $completions = [];
+            foreach ($missing as $shard) {
+                $completions[$shard] = $this->writeOperation()
+                    ->addTask(new CreateObjectTask(CreateMode::Exclusive))
+                    ->addTask(new SetXAttributeTask(static::EPOCH_ATTRIBUTE, $epoch))
+                    ->operateAsync($this->getShardObject($shard));
+            }
+            $shards = [];
+            foreach ($this->waitForErrors($completions) as $shard => $exception) {
+                if (!$exception->is(Errno::EEXIST)) {
+                    throw $exception;
+                }
+                $shards[] = $shard;
+            }
+        }
+    }
+
+    /**
+     * Run an action that uses guarded shard operations, reloading the layout and retrying it if the layout changed
+     *
+     * @param Closure(): bool $action - returns false if a guarded operation failed because of the shard epoch
+     * @return void
+     * @throws RadosException
+     */
+    protected function withLayoutGuard(Closure $action): void
+    {
+        for ($attempt = 0; $attempt < static::MAX_LAYOUT_ATTEMPTS; $attempt++) {
+            if ($action()) {
+                return;
+            }
+            $epoch = $this->epoch;
+            $this->refresh();
+            if ($this->epoch === $epoch) {
+                // The shards have not been stamped with the current epoch yet, e.g. because resharding was interrupted
+                $this->stampShards();
+            }
+        }
+        throw new KeyValueStoreException("Shard layout of store " . $this->name . " did not match after " . static::MAX_LAYOUT_ATTEMPTS . " attempts");
+    }
+
+    /**
+     * @param int $epoch
+     * @return string - zero-padded, so that epochs can be compared as strings by the OSD
+     */
+    protected function encodeEpoch(int $epoch): string
+    {
+        return sprintf("%020d", $epoch);
+    }
+
+    /**
+     * @param int $shardCount
+     * @return array<string, string> - attributes of the metadata object
+     * @throws RadosException
+     */
+    protected function create(int $shardCount): array
+    {
+        if ($shardCount < 1) {
+            throw new InvalidArgumentException("Shard count must be at least 1");
+        }
+
+        try {
+            $this->writeOperation()
+                ->addTask(new CreateObjectTask(CreateMode::Exclusive))
+                ->addTask(new SetXAttributeTask(static::SHARD_COUNT_ATTRIBUTE, (string)$shardCount))
+                ->addTask(new SetXAttributeTask(static::EPOCH_ATTRIBUTE, $this->encodeEpoch(1)))
+                ->operate($this->getMetadataObject());
+        } catch (RadosException $e) {
+            if (!$e->is(Errno::EEXIST)) {
+                throw $e;
+            }
+            // Created concurrently by another client
+            return iterator_to_array($this->getMetadataObject()->getXAttributes());
+        }
+        return [static::SHARD_COUNT_ATTRIBUTE => (string)$shardCount, static::EPOCH_ATTRIBUTE => $this->encodeEpoch(1)];
+    }
+
+    /**
+     * Move keys from a shard to their new shards while resharding
+     *
+     * Keys that were already written to their new shard are not overwritten. Since a key can be written
+     * after it was checked, the writes assert that the keys are still missing on the new shard
+     * and are retried without the keys that were written in between.
+     *
+     * @param int $shard
+     * @param array<string, string> $values
+     * @return void
+     * @throws RadosException
+     */
+    protected function moveKeys(int $shard, array $values): void
+    {
+        if (count($values) === 0) {
+            return;
+        }
+
+        $keys = array_map("strval", array_keys($values));
+        $remaining = $values;
+        for ($attempt = 0; count($remaining) > 0; $attempt++) {
+            if ($attempt >= static::MAX_LAYOUT_ATTEMPTS) {
+                throw new KeyValueStoreException("Could not move keys of shard " . $shard . " of store " . $this->name);
+            }
+
+            $existing = $this->readKeys($this->targetRing->groupKeys(array_map("strval", array_keys($remaining))));
+            if ($existing === null) {
+                throw new KeyValueStoreException("Shard layout of store " . $this->name . " was changed concurrently while resharding");
+            }
+            $groups = [];
+            foreach ($remaining as $key => $value) {
+                if (!isset($existing[$key])) {
+                    $groups[$this->targetRing->getShard($key)][(string)$key] = $value;
+                }
+            }
+
+            $completions = [];
+            foreach ($groups as $target => $targetValues) {
+                $operation = $this->guardedWriteOperation();
+                foreach ($targetValues as $key => $value) {
+                    $operation->addTask(new OMapCompareTask($key, ""));
+                }
+                $completions[$target] = $operation
+                    ->addTask(new OMapSetTask($targetValues))
+                    ->operateAsync($this->getShardObject($target));
+            }
+
+            $remaining = [];
+            foreach ($this->waitForErrors($completions) as $target => $exception) {
+                if (!$exception->is(Errno::ECANCELED)) {
+                    throw $exception;
+                }
+                $remaining += $groups[$target];
+            }
+        }
+
+        if (!$this->removeKeys([$shard => $keys])) {
+            throw new KeyValueStoreException("Shard layout of store " . $this->name . " was changed concurrently while resharding");
+        }
+    }
+
+    /**
+     * Get keys that are stored on a different shard before resharding, grouped by their old shard
+     *
+     * @param array $keys
+     * @return array<int, string[]>
+     */
+    protected function getMovedKeys(array $keys): array
+    {
+        $groups = [];
+        foreach ($keys as $key) {
+            $key = (string)$key;
+            $shard = $this->ring->getShard($key);
+            if ($shard !== $this->targetRing->getShard($key)) {
+                $groups[$shard][] = $key;
+            }
+        }
+        return $groups;
+    }
+
+    /**
+     * @param array<int, string[]> $groups
+     * @return array<string, string>|null - null if the shard layout changed
+     * @throws RadosException
+     */
+    protected function readKeys(array $groups): ?array
+    {
+        $tasks = [];
+        $completions = [];
+        foreach ($groups as $shard => $keys) {
+            $tasks[$shard] = new OMapGetByKeysTask($keys);
+            $completions[$shard] = $this->readOperation()
+                ->addTask($this->createEpochGuard())
+                ->addTask($tasks[$shard])
+                ->operateAsync($this->getShardObject($shard));
+        }
+        if (!$this->waitGuarded($completions)) {
+            return null;
+        }
+
+        $values = [];
+        foreach ($tasks as $task) {
+            foreach ($task->getResult()->getIterator() as $key => $value) {
+                $values[$key] = $value;
+            }
+        }
+        return $values;
+    }
+
+    /**
+     * @param array<int, string[]> $groups
+     * @return bool - false if the shard layout changed
+     * @throws RadosException
+     */
+    protected function removeKeys(array $groups): bool
+    {
+        $completions = [];
+        foreach ($groups as $shard => $keys) {
+            $completions[] = $this->guardedWriteOperation()
+                ->addTask(new OMapRemoveKeysTask($keys))
+                ->operateAsync($this->getShardObject($shard));
+        }
+        return $this->waitGuarded($completions);
+    }
+
+    /**
+     * @param int $shard
+     * @param string|null $startAfter
+     * @param string|null $prefix
+     * @param int $batchSize
+     * @return array{OMapGetTask, OperationCompletion}
+     * @throws RadosException
+     */
+    protected function readPageAsync(int $shard, ?string $startAfter, ?string $prefix, int $batchSize): array
+    {
+        $task = new OMapGetTask($batchSize, $startAfter, $prefix);
+        $completion = $this->readOperation()->addTask($task)->operateAsync($this->getShardObject($shard));
+        return [$task, $completion];
+    }
+
+    /**
+     * @param OMapGetTask $task
+     * @param OperationCompletion $completion
+     * @param string|null $startAfter
+     * @return array{entries: array{string, string}[], position: int, more: bool, last: ?string}
+     * @throws RadosException
+     */
+    protected function createCursor(OMapGetTask $task, OperationCompletion $completion, ?string $startAfter): array
+    {
+        if (!$this->wait($completion, true)) {
+            return ["entries" => [], "position" => 0, "more" => false, "last" => $startAfter];
+        }
+
+        $result = $task->getResult();
+        $entries = [];
+        foreach ($result->getIterator() as $key => $value) {
+            $entries[] = [$key, $value];
+        }
+        return [
+            "entries" => $entries,
+            "position" => 0,
+            "more" => $result->hasMore() && count($entries) > 0,
+            "last" => count($entries) > 0 ? $entries[count($entries) - 1][0] : $startAfter
+        ];
+    }
+
+    /**
+     * @param OperationCompletion[] $completions
+     * @param bool $ignoreMissing - ignore ENOENT errors
+     * @return void
+     * @throws RadosException
+     */
+    protected function waitAll(array $completions, bool $ignoreMissing = false): void
+    {
+        foreach ($completions as $completion) {
+            $this->wait($completion, $ignoreMissing);
+        }
+    }
+
+    /**
+     * Wait for operations that assert the shard epoch
+     *
+     * @param OperationCompletion[] $completions
+     * @return bool - false if an operation failed because the shard has a different epoch or does not exist
+     * @throws RadosException - the first other error
+     */
+    protected function waitGuarded(array $completions): bool
+    {
+        $matches = true;
+        foreach ($this->waitForErrors($completions) as $exception) {
+            if (!$exception->is(Errno::ECANCELED) && !$exception->is(Errno::ENOENT)) {
+                throw $exception;
+            }
+            $matches = false;
+        }
+        return $matches;
+    }
+
+    /**
+     * Wait for all operations and collect their errors
+     *
+     * @param array<int, OperationCompletion> $completions
+     * @return array<int, RadosException> - errors by the keys of $completions
+     */
+    protected function waitForErrors(array $completions): array
+    {
+        $errors = [];
+        foreach ($completions as $index => $completion) {
+            try {
+                $completion->waitAndGetResult();
+            } catch (RadosException $e) {
+                $errors[$index] = $e;
+            }
+        }
+        return $errors;
+    }
+
+    /**
+     * @param OperationCompletion $completion
+     * @param bool $ignoreMissing - ignore ENOENT errors
+     * @return bool - false if the object did not exist
+     * @throws RadosException
+     */
+    protected function wait(OperationCompletion $completion, bool $ignoreMissing = false): bool
+    {
+        try {
+            $completion->waitAndGetResult();
+        } catch (RadosException $e) {
+            if ($ignoreMissing && $e->is(Errno::ENOENT)) {
+                return false;
+            }
+            throw $e;
+        }
+        return true;
+    }
+
+    /**
+     * @param array $keys
+     * @return string[]
+     */
+    protected function normalizeKeys(array $keys): array
+    {
+        return array_values(array_unique(array_map("strval", $keys)));
+    }
+
+    /**
+     * @return ReadOperation
+     */
+    protected function readOperation(): ReadOperation
+    {
+        return ReadOperation::create($this->ioContext->getFFI());
+    }
+
+    /**
+     * @return WriteOperation
+     */
+    protected function writeOperation(): WriteOperation
+    {
+        return WriteOperation::create($this->ioContext->getFFI());
+    }
+
+    /**
+     * Create a write operation that only succeeds on shards with the epoch of the current layout
+     *
+     * @return WriteOperation
+     */
+    protected function guardedWriteOperation(): WriteOperation
+    {
+        return $this->writeOperation()->addTask($this->createEpochGuard());
+    }
+
+    /**
+     * @return CompareXAttributeTask
+     */
+    protected function createEpochGuard(): CompareXAttributeTask
+    {
+        return new CompareXAttributeTask(static::EPOCH_ATTRIBUTE, $this->encodeEpoch($this->epoch));
+    }
+}
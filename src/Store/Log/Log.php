@@ -0,0 +1,229 @@
+<?php
+
+namespace Aternos\Rados\Store\Log;
+
+use Aternos\Rados\Cluster\Pool\IOContext;
+use Aternos\Rados\Cluster\Pool\Object\RadosObject;
+use Aternos\Rados\Constants\CreateMode;
+use Aternos\Rados\Exception\LogException;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Generated\Errno;
+use Aternos\Rados\Operation\Common\Task\CompareXAttributeTask;
+use Aternos\Rados\Operation\Write\Task\CreateObjectTask;
+use Aternos\Rados\Operation\Write\Task\SetXAttributeTask;
+use Aternos\Rados\Operation\Write\WriteOperation;
+use InvalidArgumentException;
+
+/**
+ * Append-only log stored in a sequence of segment objects
+ *
+ * Records are length-prefixed and appended to the current head segment.
+ * Each segment has a state attribute that is checked by every append. Once a segment is full,
+ * it is sealed and appends continue in the next segment.
+ * The index of the head segment and committed consumer positions are stored in a metadata object.
+ */
+class Log
+{
+    const HEAD_ATTRIBUTE = "log.head";
+    const STATE_ATTRIBUTE = "log.state";
+    const STATE_OPEN = "open";
+    const STATE_SEALED = "sealed";
+    const CONSUMER_KEY_PREFIX = "consumer.";
+    const RECORD_HEADER_LENGTH = 4;
+    const DEFAULT_SEGMENT_SIZE = 64 * 1024 * 1024;
+
+    /**
+     * Open a log, creating it if it does not exist yet
+     *
+     * @param IOContext $ioContext
+     * @param string $name - name of the log, used as prefix for all objects of the log
+     * @param int $segmentSize - size in bytes after which a segment is sealed
+     * @return static
+     * @throws RadosException
+     */
+    public static function open(IOContext $ioContext, string $name, int $segmentSize = self::DEFAULT_SEGMENT_SIZE): static
+    {
+        $log = new static($ioContext, $name, $segmentSize);
+        try {
+            WriteOperation::create($ioContext->getFFI())
+                ->addTask(new CreateObjectTask(CreateMode::Exclusive))
+                ->addTask(new SetXAttributeTask(static::HEAD_ATTRIBUTE, "0"))
+                ->operate($log->getMetadataObject());
+        } catch (RadosException $e) {
+            if (!$e->is(Errno::EEXIST)) {
+                throw $e;
+            }
+        }
+        $log->createSegment(0);
+        return $log;
+    }
+
+    /**
+     * @param IOContext $ioContext
+     * @param string $name
+     * @param int $segmentSize
+     * @internal Use Log::open instead
+     */
+    protected function __construct(
+        protected IOContext $ioContext,
+        protected string $name,
+        protected int $segmentSize
+    )
+    {
+        if ($this->segmentSize < 1) {
+            throw new InvalidArgumentException("Segment size must be at least 1");
+        }
+    }
+
+    /**
+     * @return IOContext
+     */
+    public function getIOContext(): IOContext
+    {
+        return $this->ioContext;
+    }
+
+    /**
+     * @return string
+     */
+    public function getName(): string
+    {
+        return $this->name;
+    }
+
+    /**
+     * @return int
+     */
+    public function getSegmentSize(): int
+    {
+        return $this->segmentSize;
+    }
+
+    /**
+     * @return RadosObject
+     */
+    public function getMetadataObject(): RadosObject
+    {
+        return $this->ioContext->getObject($this->name . ".meta");
+    }
+
+    /**
+     * @param int $segment
+     * @return RadosObject
+     */
+    public function getSegmentObject(int $segment): RadosObject
+    {
+        return $this->ioContext->getObject($this->name . ".segment." . $segment);
+    }
+
+    /**
+     * Get the index of the segment that is currently appended to
+     *
+     * @return int
+     * @throws RadosException
+     */
+    public function getHeadSegment(): int
+    {
+        $head = $this->getMetadataObject()->getXAttribute(static::HEAD_ATTRIBUTE);
+        if (!ctype_digit($head)) {
+            throw new LogException("Invalid head segment in log " . $this->name);
+        }
+        return (int)$head;
+    }
+
+    /**
+     * Check whether a segment has been sealed
+     *
+     * @param int $segment
+     * @return bool
+     * @throws RadosException
+     */
+    public function isSealed(int $segment): bool
+    {
+        try {
+            return $this->getSegmentObject($segment)->getXAttribute(static::STATE_ATTRIBUTE) === static::STATE_SEALED;
+        } catch (RadosException $e) {
+            if ($e->is(Errno::ENOENT, Errno::ENODATA)) {
+                return false;
+            }
+            throw $e;
+        }
+    }
+
+    /**
+     * @param int $batchBytes - flush once this many bytes are buffered
+     * @param int $batchRecords - flush once this many records are buffered
+     * @return LogProducer
+     */
+    public function createProducer(int $batchBytes = LogProducer::DEFAULT_BATCH_BYTES, int $batchRecords = LogProducer::DEFAULT_BATCH_RECORDS): LogProducer
+    {
+        return new LogProducer($this, $batchBytes, $batchRecords);
+    }
+
+    /**
+     * @param string $group - consumer group, each group has its own committed position
+     * @param int $readAheadSize - number of bytes read from a segment at once
+     * @return LogConsumer
+     * @throws RadosException
+     */
+    public function createConsumer(string $group, int $readAheadSize = LogConsumer::DEFAULT_READ_AHEAD_SIZE): LogConsumer
+    {
+        return new LogConsumer($this, $group, $readAheadSize);
+    }
+
+    /**
+     * Seal a segment and move the head to the next segment
+     * Does nothing if another client already did so.
+     *
+     * @param int $segment
+     * @return int - index of the next segment
+     * @throws RadosException
+     * @internal Used by LogProducer
+     */
+    public function roll(int $segment): int
+    {
+        try {
+            WriteOperation::create($this->ioContext->getFFI())
+                ->addTask(new CompareXAttributeTask(static::STATE_ATTRIBUTE, static::STATE_OPEN))
+                ->addTask(new SetXAttributeTask(static::STATE_ATTRIBUTE, static::STATE_SEALED))
+                ->operate($this->getSegmentObject($segment));
+        } catch (RadosException $e) {
+            if (!$e->is(Errno::ECANCELED)) {
+                throw $e;
+            }
+        }
+
+        $next = $segment + 1;
+        $this->createSegment($next);
+        try {
+            WriteOperation::create($this->ioContext->getFFI())
+                ->addTask(new CompareXAttributeTask(static::HEAD_ATTRIBUTE, (string)$segment))
+                ->addTask(new SetXAttributeTask(static::HEAD_ATTRIBUTE, (string)$next))
+                ->operate($this->getMetadataObject());
+        } catch (RadosException $e) {
+            if (!$e->is(Errno::ECANCELED)) {
+                throw $e;
+            }
+        }
+        return $next;
+    }
+
+    /**
+     * @param int $segment
+     * @return void
+     * @throws RadosException
+     */
+    protected function createSegment(int $segment): void
+    {
+        try {
+            WriteOperation::create($this->ioContext->getFFI())
+                ->addTask(new CreateObjectTask(CreateMode::Exclusive))
+                ->addTask(new SetXAttributeTask(static::STATE_ATTRIBUTE, static::STATE_OPEN))
+                ->operate($this->getSegmentObject($segment));
+        } catch (RadosException $e) {
+            if (!$e->is(Errno::EEXIST)) {
+                throw $e;
+            }
+        }
+    }
+}
@@ -0,0 +1,244 @@
+<?php
+
+namespace Aternos\Rados\Store\Log;
+
+use Aternos\Rados\Completion\ReadCompletion;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Generated\Errno;
+use Aternos\Rados\Operation\Read\ReadOperation;
+use Aternos\Rados\Operation\Read\Task\OMapGetByKeysTask;
+use Aternos\Rados\Operation\Write\Task\OMapSetTask;
+use Aternos\Rados\Operation\Write\WriteOperation;
+use InvalidArgumentException;
+
+/**
+ * Reads records from a log, starting at the committed position of its consumer group
+ *
+ * Segments are read in chunks of the read-ahead size. When a chunk was full,
+ * the next chunk is requested asynchronously while the current one is processed.
+ */
+class LogConsumer
+{
+    const DEFAULT_READ_AHEAD_SIZE = 1024 * 1024;
+
+    protected LogPosition $position;
+    protected string $buffer = "";
+    protected int $bufferOffset = 0;
+    protected ?ReadCompletion $readAhead = null;
+    protected int $readAheadOffset = 0;
+
+    /**
+     * @param Log $log
+     * @param string $group - consumer group, each group has its own committed position
+     * @param int $readAheadSize - number of bytes read from a segment at once
+     * @throws RadosException
+     * @internal Use Log::createConsumer instead
+     */
+    public function __construct(
+        protected Log $log,
+        protected string $group,
+        protected int $readAheadSize = self::DEFAULT_READ_AHEAD_SIZE
+    )
+    {
+        if ($this->readAheadSize < Log::RECORD_HEADER_LENGTH) {
+            throw new InvalidArgumentException("Read-ahead size must be at least " . Log::RECORD_HEADER_LENGTH);
+        }
+        $this->position = $this->getCommittedPosition() ?? new LogPosition(0, 0);
+        $this->bufferOffset = $this->position->getOffset();
+    }
+
+    public function __destruct()
+    {
+        $this->discardReadAhead();
+    }
+
+    /**
+     * Get the position of the next record that will be read
+     *
+     * @return LogPosition
+     */
+    public function getPosition(): LogPosition
+    {
+        return $this->position;
+    }
+
+    /**
+     * Continue reading at a different position
+     *
+     * @param LogPosition $position
+     * @return $this
+     */
+    public function seek(LogPosition $position): static
+    {
+        $this->position = $position;
+        $this->resetBuffer($position->getOffset());
+        return $this;
+    }
+
+    /**
+     * Read the committed position of this consumer group
+     *
+     * @return LogPosition|null - null if no position was committed yet
+     * @throws RadosException
+     */
+    public function getCommittedPosition(): ?LogPosition
+    {
+        $key = Log::CONSUMER_KEY_PREFIX . $this->group;
+        $task = new OMapGetByKeysTask([$key]);
+        ReadOperation::create($this->log->getIOContext()->getFFI())
+            ->addTask($task)
+            ->operate($this->log->getMetadataObject());
+
+        foreach ($task->getResult()->getIterator() as $entryKey => $value) {
+            if ($entryKey === $key) {
+                return LogPosition::fromString($value);
+            }
+        }
+        return null;
+    }
+
+    /**
+     * Store a position as committed position of this consumer group
+     *
+     * @param LogPosition|null $position - defaults to the current position
+     * @return $this
+     * @throws RadosException
+     */
+    public function commit(?LogPosition $position = null): static
+    {
+        $position ??= $this->position;
+        WriteOperation::create($this->log->getIOContext()->getFFI())
+            ->addTask(new OMapSetTask([Log::CONSUMER_KEY_PREFIX . $this->group => $position->toString()]))
+            ->operate($this->log->getMetadataObject());
+        return $this;
+    }
+
+    /**
+     * Read the next records
+     * Returns fewer records than requested (or none) once the end of the log is reached.
+     *
+     * @param int $maxRecords
+     * @return LogRecord[]
+     * @throws RadosException
+     */
+    public function poll(int $maxRecords = 1000): array
+    {
+        $records = [];
+        while (count($records) < $maxRecords) {
+            $record = $this->parseRecord();
+            if ($record !== null) {
+                $records[] = $record;
+                $this->position = $record->getNextPosition();
+                continue;
+            }
+
+            if ($this->fetch()) {
+                continue;
+            }
+
+            if (!$this->log->isSealed($this->position->getSegment())) {
+                break;
+            }
+
+            // Appends are guarded by the segment state, so data written before sealing is the last data of the segment
+            if ($this->fetch()) {
+                continue;
+            }
+
+            $this->position = new LogPosition($this->position->getSegment() + 1, 0);
+            $this->resetBuffer(0);
+        }
+        return $records;
+    }
+
+    /**
+     * @return LogRecord|null
+     */
+    protected function parseRecord(): ?LogRecord
+    {
+        $start = $this->position->getOffset() - $this->bufferOffset;
+        if (strlen($this->buffer) - $start < Log::RECORD_HEADER_LENGTH) {
+            return null;
+        }
+
+        $length = unpack("N", $this->buffer, $start)[1];
+        if (strlen($this->buffer) - $start - Log::RECORD_HEADER_LENGTH < $length) {
+            return null;
+        }
+
+        return new LogRecord(
+            $this->position,
+            new LogPosition(
+                $this->position->getSegment(),
+                $this->position->getOffset() + Log::RECORD_HEADER_LENGTH + $length
+            ),
+            substr($this->buffer, $start + Log::RECORD_HEADER_LENGTH, $length)
+        );
+    }
+
+    /**
+     * Read the next chunk of the current segment into the buffer
+     *
+     * @return bool - false if no new data was available
+     * @throws RadosException
+     */
+    protected function fetch(): bool
+    {
+        // Drop records that were already returned
+        $consumed = $this->position->getOffset() - $this->bufferOffset;
+        if ($consumed > 0) {
+            $this->buffer = substr($this->buffer, $consumed);
+            $this->bufferOffset = $this->position->getOffset();
+        }
+
+        $offset = $this->bufferOffset + strlen($this->buffer);
+        $object = $this->log->getSegmentObject($this->position->getSegment());
+        try {
+            if ($this->readAhead !== null && $this->readAheadOffset === $offset) {
+                $data = $this->readAhead->waitAndGetResult();
+            } else {
+                $this->discardReadAhead();
+                $data = $object->read($this->readAheadSize, $offset);
+            }
+        } catch (RadosException $e) {
+            if (!$e->is(Errno::ENOENT)) {
+                throw $e;
+            }
+            $data = "";
+        } finally {
+            $this->discardReadAhead();
+        }
+
+        if (strlen($data) === $this->readAheadSize) {
+            $this->readAheadOffset = $offset + strlen($data);
+            $this->readAhead = $object->readAsync($this->readAheadSize, $this->readAheadOffset);
+        }
+
+        $this->buffer .= $data;
+        return strlen($data) > 0;
+    }
+
+    /**
+     * @param int $offset
+     * @return void
+     */
+    protected function resetBuffer(int $offset): void
+    {
+        $this->buffer = "";
+        $this->bufferOffset = $offset;
+        $this->discardReadAhead();
+    }
+
+    /**
+     * Drop the pending read-ahead
+     *
+     * The completion owns the buffer that librados reads into, so it has to be complete before it is released.
+     *
+     * @return void
+     */
+    protected function discardReadAhead(): void
+    {
+        $this->readAhead?->waitForComplete();
+        $this->readAhead = null;
+    }
+}
@@ -0,0 +1,56 @@
+<?php
+
+namespace Aternos\Rados\Store\Log;
+
+use InvalidArgumentException;
+
+class LogPosition
+{
+    /**
+     * @param string $value - position in the format "segment:offset"
+     * @return static
+     */
+    public static function fromString(string $value): static
+    {
+        $parts = explode(":", $value);
+        if (count($parts) !== 2 || !ctype_digit($parts[0]) || !ctype_digit($parts[1])) {
+            throw new InvalidArgumentException("Invalid log position: " . $value);
+        }
+        return new static((int)$parts[0], (int)$parts[1]);
+    }
+
+    /**
+     * @param int $segment - index of the segment object
+     * @param int $offset - byte offset within the segment
+     */
+    public function __construct(
+        protected int $segment,
+        protected int $offset
+    )
+    {
+    }
+
+    /**
+     * @return int
+     */
+    public function getSegment(): int
+    {
+        return $this->segment;
+    }
+
+    /**
+     * @return int
+     */
+    public function getOffset(): int
+    {
+        return $this->offset;
+    }
+
+    /**
+     * @return string
+     */
+    public function toString(): string
+    {
+        return $this->segment . ":" . $this->offset;
+    }
+}
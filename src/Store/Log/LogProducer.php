@@ -0,0 +1,142 @@
+<?php
+
+namespace Aternos\Rados\Store\Log;
+
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Generated\Errno;
+use Aternos\Rados\Operation\Common\Task\AssertVersionTask;
+use Aternos\Rados\Operation\Common\Task\CompareXAttributeTask;
+use Aternos\Rados\Operation\Write\Task\AppendTask;
+use Aternos\Rados\Operation\Write\WriteOperation;
+use InvalidArgumentException;
+
+/**
+ * Buffers records and appends them to the log in batches (group commit)
+ *
+ * Each batch is written as a single append that is guarded by the state attribute of the segment,
+ * so batches of concurrent producers never end up in a sealed segment.
+ * The append also asserts the object version of the segment the producer has last seen,
+ * so the size check uses the actual segment length even if other producers appended in between.
+ *
+ * @note Buffered records are only written on flush(), which is called automatically once a batch is full
+ */
+class LogProducer
+{
+    const DEFAULT_BATCH_BYTES = 1024 * 1024;
+    const DEFAULT_BATCH_RECORDS = 10000;
+
+    protected string $buffer = "";
+    protected int $bufferedRecords = 0;
+    protected ?int $segment = null;
+    protected int $segmentLength = 0;
+    protected int $segmentVersion = 0;
+
+    /**
+     * @param Log $log
+     * @param int $batchBytes - flush once this many bytes are buffered
+     * @param int $batchRecords - flush once this many records are buffered
+     * @internal Use Log::createProducer instead
+     */
+    public function __construct(
+        protected Log $log,
+        protected int $batchBytes = self::DEFAULT_BATCH_BYTES,
+        protected int $batchRecords = self::DEFAULT_BATCH_RECORDS
+    )
+    {
+        if ($this->batchBytes < 1 || $this->batchRecords < 1) {
+            throw new InvalidArgumentException("Batch limits must be at least 1");
+        }
+    }
+
+    /**
+     * Add a record to the current batch
+     *
+     * @param string $record
+     * @return $this
+     * @throws RadosException
+     */
+    public function append(string $record): static
+    {
+        $this->buffer .= pack("N", strlen($record)) . $record;
+        $this->bufferedRecords++;
+        if (strlen($this->buffer) >= $this->batchBytes || $this->bufferedRecords >= $this->batchRecords) {
+            $this->flush();
+        }
+        return $this;
+    }
+
+    /**
+     * Get the number of records that have not been written yet
+     *
+     * @return int
+     */
+    public function getBufferedRecords(): int
+    {
+        return $this->bufferedRecords;
+    }
+
+    /**
+     * Write all buffered records to the log with a single append
+     *
+     * @return $this
+     * @throws RadosException
+     */
+    public function flush(): static
+    {
+        if ($this->bufferedRecords === 0) {
+            return $this;
+        }
+
+        $length = strlen($this->buffer);
+        while (true) {
+            if ($this->segment === null) {
+                $this->advance($this->log->getHeadSegment());
+            }
+
+            // Batches larger than a segment are written to an empty segment
+            if ($this->segmentLength > 0 && $this->segmentLength + $length > $this->log->getSegmentSize()) {
+                $this->advance($this->log->roll($this->segment));
+                continue;
+            }
+
+            try {
+                WriteOperation::create($this->log->getIOContext()->getFFI())
+                    ->addTask(new CompareXAttributeTask(Log::STATE_ATTRIBUTE, Log::STATE_OPEN))
+                    ->addTask(new AssertVersionTask($this->segmentVersion))
+                    ->addTask(new AppendTask($this->buffer))
+                    ->operate($this->log->getSegmentObject($this->segment));
+            } catch (RadosException $e) {
+                if ($e->is(Errno::ERANGE) || $e->is(Errno::EOVERFLOW)) {
+                    // Written by another producer, reload the segment length
+                    $this->advance($this->segment);
+                    continue;
+                }
+                if (!$e->is(Errno::ECANCELED)) {
+                    throw $e;
+                }
+                // Sealed by another producer
+                $this->advance($this->log->roll($this->segment));
+                continue;
+            }
+            break;
+        }
+
+        $this->segmentLength += $length;
+        $this->segmentVersion = $this->log->getIOContext()->getLastVersion();
+        $this->buffer = "";
+        $this->bufferedRecords = 0;
+        return $this;
+    }
+
+    /**
+     * @param int $segment
+     * @return void
+     * @throws RadosException
+     */
+    protected function advance(int $segment): void
+    {
+        $this->segment = $segment;
+        $this->segmentLength = $this->log->getSegmentObject($segment)->stat()->getSize();
+        $this->segmentVersion = $this->log->getIOContext()->getLastVersion();
+    }
+}
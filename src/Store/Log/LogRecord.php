@@ -0,0 +1,43 @@
+<?php
+
+namespace Aternos\Rados\Store\Log;
+
+class LogRecord
+{
+    /**
+     * @param LogPosition $position - position of the record
+     * @param LogPosition $nextPosition - position after the record
+     * @param string $data
+     */
+    public function __construct(
+        protected LogPosition $position,
+        protected LogPosition $nextPosition,
+        protected string $data
+    )
+    {
+    }
+
+    /**
+     * @return LogPosition
+     */
+    public function getPosition(): LogPosition
+    {
+        return $this->position;
+    }
+
+    /**
+     * @return LogPosition
+     */
+    public function getNextPosition(): LogPosition
+    {
+        return $this->nextPosition;
+    }
+
+    /**
+     * @return string
+     */
+    public function getData(): string
+    {
+        return $this->data;
+    }
+}
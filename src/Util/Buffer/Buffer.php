@@ -65,6 +65,19 @@ class Buffer extends WrappedType
         return $this->size;
     }
 
+    /**
+     * Create a view on a part of this buffer
+     * Views can be passed to write functions without copying the data into a string.
+     *
+     * @param int $offset
+     * @param int|null $length - length of the view, or null for the rest of the buffer
+     * @return BufferView
+     */
+    public function view(int $offset = 0, ?int $length = null): BufferView
+    {
+        return new BufferView($this, $offset, $length);
+    }
+
     /**
      * Convert this buffer to a string
      *
@@ -0,0 +1,149 @@
+<?php
+
+namespace Aternos\Rados\Util\Buffer;
+
+use FFI;
+use FFI\CData;
+use InvalidArgumentException;
+
+/**
+ * Slice of a buffer that can be passed to write functions instead of a string
+ *
+ * A view does not copy the data of the buffer, changes to the buffer are visible through the view.
+ * The view keeps a reference to its buffer, so the buffer is not released while the view is in use.
+ */
+class BufferView
+{
+    /**
+     * Get a pointer to the data of a string, buffer or buffer view
+     *
+     * @param string|Buffer|BufferView $data
+     * @return string|CData
+     * @internal
+     */
+    public static function pointer(string|Buffer|BufferView $data): string|CData
+    {
+        if ($data instanceof Buffer || $data instanceof BufferView) {
+            return $data->getCData();
+        }
+        return $data;
+    }
+
+    /**
+     * Get the length of a string, buffer or buffer view in bytes
+     *
+     * @param string|Buffer|BufferView $data
+     * @return int
+     * @internal
+     */
+    public static function length(string|Buffer|BufferView $data): int
+    {
+        if ($data instanceof Buffer) {
+            return $data->getSize();
+        }
+        if ($data instanceof BufferView) {
+            return $data->getLength();
+        }
+        return strlen($data);
+    }
+
+    protected int $length;
+
+    /**
+     * @param Buffer $buffer
+     * @param int $offset - offset of the first byte of the view in the buffer
+     * @param int|null $length - length of the view, or null for the rest of the buffer
+     */
+    public function __construct(
+        protected Buffer $buffer,
+        protected int $offset = 0,
+        ?int $length = null
+    )
+    {
+        $length ??= $buffer->getSize() - $offset;
+        if ($offset < 0 || $length < 0 || $offset + $length > $buffer->getSize()) {
+            throw new InvalidArgumentException("View is out of the bounds of the buffer");
+        }
+        $this->length = $length;
+    }
+
+    /**
+     * @return Buffer
+     */
+    public function getBuffer(): Buffer
+    {
+        return $this->buffer;
+    }
+
+    /**
+     * @return int
+     */
+    public function getOffset(): int
+    {
+        return $this->offset;
+    }
+
+    /**
+     * @return int
+     */
+    public function getLength(): int
+    {
+        return $this->length;
+    }
+
+    /**
+     * Get a pointer to the first byte of the view
+     *
+     * @return CData
+     */
+    public function getCData(): CData
+    {
+        $data = $this->buffer->getCData();
+        if ($this->offset === 0 || $this->offset === $this->buffer->getSize()) {
+            return $data;
+        }
+        return FFI::addr($data[$this->offset]);
+    }
+
+    /**
+     * Create a view on a part of this view
+     *
+     * @param int $offset - offset relative to this view
+     * @param int|null $length - length of the new view, or null for the rest of this view
+     * @return static
+     */
+    public function slice(int $offset, ?int $length = null): static
+    {
+        $length ??= $this->length - $offset;
+        if ($offset < 0 || $length < 0 || $offset + $length > $this->length) {
+            throw new InvalidArgumentException("Slice is out of the bounds of the view");
+        }
+        return new static($this->buffer, $this->offset + $offset, $length);
+    }
+
+    /**
+     * Copy the content of the view into a string
+     *
+     * @return string
+     */
+    public function toString(): string
+    {
+        return $this->readString();
+    }
+
+    /**
+     * Read a string from the start of the view
+     * If length is null, the whole view is read
+     *
+     * @param int|null $length
+     * @return string
+     */
+    public function readString(?int $length = null): string
+    {
+        $length = min($length ?? $this->length, $this->length);
+        if ($length === 0) {
+            return "";
+        }
+        return FFI::string($this->getCData(), $length);
+    }
+}
@@ -0,0 +1,33 @@
+<?php
+
+namespace Aternos\Rados\Util\Buffer;
+
+use FFI;
+use FFI\CData;
+
+/**
+ * Buffer backed by a memory mapped region of a local file
+ * The region is unmapped when the buffer is released.
+ */
+class MappedBuffer extends Buffer
+{
+    /**
+     * @param int $size - length of the mapped region
+     * @param CData $data - char pointer to the start of the mapped region
+     * @param FFI $ffi - libc FFI context
+     * @internal Use LocalFile::map instead
+     */
+    public function __construct(int $size, CData $data, FFI $ffi)
+    {
+        parent::__construct($size, $data, $ffi);
+    }
+
+    /**
+     * @inheritDoc
+     * @noinspection PhpUndefinedMethodInspection
+     */
+    protected function releaseCData(): void
+    {
+        $this->ffi->munmap($this->getCDataUnsafe(), $this->size);
+    }
+}
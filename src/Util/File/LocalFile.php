@@ -0,0 +1,220 @@
+<?php
+
+namespace Aternos\Rados\Util\File;
+
+use Aternos\Rados\Exception\LocalFileException;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Generated\Errno;
+use Aternos\Rados\Util\Buffer\Buffer;
+use Aternos\Rados\Util\Buffer\BufferView;
+use Aternos\Rados\Util\Buffer\MappedBuffer;
+use FFI;
+
+/**
+ * File descriptor of a local file, opened with libc through FFI
+ *
+ * Used to transfer files to and from objects without reading them into PHP strings.
+ * The constants are the values for Linux.
+ *
+ * @internal Used by RadosObject::uploadFile and RadosObject::downloadFile
+ */
+class LocalFile
+{
+    const O_RDONLY = 0;
+    const O_RDWR = 2;
+    const O_CREAT = 0100;
+    const O_TRUNC = 01000;
+    const O_CLOEXEC = 02000000;
+    const SEEK_END = 2;
+    const PROT_READ = 1;
+    const PROT_WRITE = 2;
+    const MAP_SHARED = 1;
+    const MADV_SEQUENTIAL = 2;
+
+    /**
+     * Binding for open
+     *
+     * @param FFI $libc
+     * @param string $path
+     * @param int $flags - O_* flags, O_CLOEXEC is always added
+     * @param int $mode - permissions of a newly created file
+     * @return static
+     * @throws RadosException
+     * @noinspection PhpUndefinedMethodInspection
+     */
+    public static function open(FFI $libc, string $path, int $flags, int $mode = 0644): static
+    {
+        $fd = $libc->open($path, $flags | static::O_CLOEXEC, $mode);
+        if ($fd < 0) {
+            throw static::createException($libc, "Failed to open " . $path);
+        }
+        return new static($libc, $fd, $path);
+    }
+
+    /**
+     * Create an exception from the current errno
+     *
+     * @param FFI $libc
+     * @param string $message
+     * @return LocalFileException
+     * @noinspection PhpUndefinedMethodInspection
+     */
+    protected static function createException(FFI $libc, string $message): LocalFileException
+    {
+        $errno = $libc->__errno_location()[0];
+        return new LocalFileException($message . ": " . Errno::getErrorName($errno), -$errno);
+    }
+
+    /**
+     * @param FFI $libc
+     * @param int $fd
+     * @param string $path
+     */
+    protected function __construct(
+        protected FFI $libc,
+        protected ?int $fd,
+        protected string $path
+    )
+    {
+    }
+
+    public function __destruct()
+    {
+        $this->close();
+    }
+
+    /**
+     * Get the size of the file
+     *
+     * @return int
+     * @throws RadosException
+     * @noinspection PhpUndefinedMethodInspection
+     */
+    public function getSize(): int
+    {
+        $size = $this->libc->lseek($this->getFd(), 0, static::SEEK_END);
+        if ($size < 0) {
+            throw static::createException($this->libc, "Failed to get size of " . $this->path);
+        }
+        return $size;
+    }
+
+    /**
+     * Binding for ftruncate
+     *
+     * @param int $size
+     * @return $this
+     * @throws RadosException
+     * @noinspection PhpUndefinedMethodInspection
+     */
+    public function truncate(int $size): static
+    {
+        if ($this->libc->ftruncate($this->getFd(), $size) < 0) {
+            throw static::createException($this->libc, "Failed to truncate " . $this->path);
+        }
+        return $this;
+    }
+
+    /**
+     * Binding for mmap
+     * Map the first $length bytes of the file into memory
+     *
+     * Returns null if the file cannot be mapped, e.g. because the file system does not support it.
+     *
+     * @param int $length
+     * @param bool $writable - map the file writable and shared, so that writes to the buffer change the file
+     * @return MappedBuffer|null
+     * @noinspection PhpUndefinedMethodInspection
+     */
+    public function map(int $length, bool $writable = false): ?MappedBuffer
+    {
+        $protection = $writable ? static::PROT_READ | static::PROT_WRITE : static::PROT_READ;
+        $pointer = $this->libc->mmap(null, $length, $protection, static::MAP_SHARED, $this->getFd(), 0);
+        if ($pointer === null || $this->libc->cast("intptr_t", $pointer)->cdata === -1) {
+            return null;
+        }
+        if (!$writable) {
+            $this->libc->madvise($pointer, $length, static::MADV_SEQUENTIAL);
+        }
+        return new MappedBuffer($length, $this->libc->cast("char *", $pointer), $this->libc);
+    }
+
+    /**
+     * Binding for pread
+     * Read up to $length bytes at $offset into the start of $buffer
+     *
+     * @param Buffer $buffer
+     * @param int $length
+     * @param int $offset
+     * @return int - number of bytes read, 0 at the end of the file
+     * @throws RadosException
+     * @noinspection PhpUndefinedMethodInspection
+     */
+    public function read(Buffer $buffer, int $length, int $offset): int
+    {
+        $length = min($length, $buffer->getSize());
+        $read = 0;
+        while ($read < $length) {
+            $result = $this->libc->pread($this->getFd(), $buffer->view($read)->getCData(), $length - $read, $offset + $read);
+            if ($result < 0) {
+                throw static::createException($this->libc, "Failed to read from " . $this->path);
+            }
+            if ($result === 0) {
+                break;
+            }
+            $read += $result;
+        }
+        return $read;
+    }
+
+    /**
+     * Binding for pwrite
+     * Write the whole content of $data at $offset
+     *
+     * @param Buffer|BufferView $data
+     * @param int $offset
+     * @return $this
+     * @throws RadosException
+     * @noinspection PhpUndefinedMethodInspection
+     */
+    public function write(Buffer|BufferView $data, int $offset): static
+    {
+        $view = $data instanceof Buffer ? $data->view() : $data;
+        $written = 0;
+        while ($written < $view->getLength()) {
+            $result = $this->libc->pwrite($this->getFd(), $view->slice($written)->getCData(), $view->getLength() - $written, $offset + $written);
+            if ($result <= 0) {
+                throw static::createException($this->libc, "Failed to write to " . $this->path);
+            }
+            $written += $result;
+        }
+        return $this;
+    }
+
+    /**
+     * Binding for close
+     *
+     * @return $this
+     * @noinspection PhpUndefinedMethodInspection
+     */
+    public function close(): static
+    {
+        if ($this->fd !== null) {
+            $this->libc->close($this->fd);
+            $this->fd = null;
+        }
+        return $this;
+    }
+
+    /**
+     * @return int
+     * @throws LocalFileException
+     */
+    protected function getFd(): int
+    {
+        if ($this->fd === null) {
+            throw new LocalFileException("File " . $this->path . " has already been closed");
+        }
+        return $this->fd;
+    }
+}
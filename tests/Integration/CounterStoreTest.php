@@ -0,0 +1,61 @@
+<?php
+
+namespace Tests\Integration;
+
+use Aternos\Rados\Store\Counter\CounterStore;
+use Aternos\Rados\Store\Counter\NumOps;
+use Tests\RadosTestCase;
+
+class CounterStoreTest extends RadosTestCase
+{
+    public function testIncrement(): void
+    {
+        $store = new CounterStore($this->getIOContext());
+        $objectId = "counters-" . uniqid();
+
+        $this->assertSame(0, $store->get($objectId, "missing"));
+        $store->increment($objectId, "views");
+        $store->increment($objectId, "views", 41);
+        $store->incrementAsync($objectId, "views", -2)->waitAndGetResult();
+        $this->assertSame(40, $store->get($objectId, "views"));
+
+        $store->increment($objectId, "ratio", 0.5);
+        $this->assertSame(0.5, $store->get($objectId, "ratio"));
+    }
+
+    public function testMultiplyAndSet(): void
+    {
+        $store = new CounterStore($this->getIOContext());
+        $objectId = "counters-" . uniqid();
+
+        $store->set($objectId, "value", 3)->multiply($objectId, "value", 7);
+        $this->assertSame(21, $store->get($objectId, "value"));
+    }
+
+    public function testBatch(): void
+    {
+        $store = new CounterStore($this->getIOContext());
+        $first = "counters-" . uniqid();
+        $second = "counters-" . uniqid();
+
+        $batch = $store->createBatch();
+        for ($i = 0; $i < 10; $i++) {
+            $batch->add($first, "a")->add($second, "b", 2);
+        }
+        $batch->add($first, "c", 5)->multiply($first, "c", 3)->set($second, "d", 100)->add($second, "d", 1);
+        $this->assertEquals(6, $batch->getUpdateCount());
+        $batch->execute();
+        $this->assertTrue($batch->isEmpty());
+
+        $this->assertSame(["a" => 10, "c" => 15, "x" => 0], $store->getMany($first, ["a", "c", "x"]));
+        $this->assertSame(["b" => 20, "d" => 101], $store->getMany($second, ["b", "d"]));
+    }
+
+    public function testEncodeInput(): void
+    {
+        $this->assertEquals("\x03\x00\x00\x00key\x02\x00\x00\x00-1", NumOps::encodeInput("key", -1));
+        $this->assertEquals("1.5", NumOps::formatValue(1.5));
+        $this->assertSame(12, NumOps::parseValue("12"));
+        $this->assertSame(2.25, NumOps::parseValue("2.25"));
+    }
+}
@@ -0,0 +1,69 @@
+<?php
+
+namespace Tests\Integration;
+
+use Aternos\Rados\Cluster\Pool\Latency\LatencyPolicy;
+use Aternos\Rados\Operation\Read\Task\ReadTask;
+use Tests\RadosTestCase;
+
+class LatencyPolicyTest extends RadosTestCase
+{
+    public function testWaitWithTimeout(): void
+    {
+        $object = $this->getIOContext()->getObject("latency-" . uniqid());
+        $object->writeFull("test-data");
+
+        $completion = $object->readAsync(9, 0);
+        $this->assertEquals("test-data", $completion->waitAndGetResult(10));
+
+        $operation = $this->getRados()->createReadOperation();
+        $task = new ReadTask(4, 5);
+        $operation->addTask($task)->operateWithTimeout($object, 10);
+        $this->assertEquals("data", $task->getResult());
+    }
+
+    public function testPolicyTimeoutIsOptIn(): void
+    {
+        $ioContext = $this->getIOContext();
+        $object = $ioContext->getObject("latency-opt-in-" . uniqid());
+
+        $ioContext->setLatencyPolicy(new LatencyPolicy(0.000001));
+        try {
+            $object->writeFull("test-data");
+            $this->assertEquals("test-data", $object->readAsync(9, 0)->waitAndGetResult());
+        } finally {
+            $ioContext->setLatencyPolicy(null);
+        }
+    }
+
+    public function testHedgedRead(): void
+    {
+        $object = $this->getIOContext()->getObject("latency-hedged-" . uniqid());
+        $object->writeFull("test-data");
+
+        $policy = new LatencyPolicy(10, 0);
+        for ($i = 0; $i < 5; $i++) {
+            $this->assertEquals("test-data", $object->readHedged(9, 0, $policy));
+        }
+
+        $this->assertEquals(5, $policy->getEffectiveLatencies()->getCount());
+        $policy->waitForPendingPrimaries();
+        $this->assertEquals(5, $policy->getPrimaryLatencies()->getCount() + $policy->getUnmeasuredPrimaryCount());
+        $this->assertEquals(0, $policy->getAbandonedPrimaryCount());
+        $this->assertNotNull($policy->getEffectiveLatencies()->getP99());
+        $this->assertEquals(0, $policy->getTimeoutCount());
+    }
+
+    public function testHedgedPreparedOperation(): void
+    {
+        $ioContext = $this->getIOContext();
+        $object = $ioContext->getObject("latency-prepared-" . uniqid());
+        $object->writeFull("test-data");
+
+        $ioContext->setLatencyPolicy(new LatencyPolicy(10, 0.001));
+        $operation = $this->getRados()->createPreparedReadOperation(fn() => [new ReadTask(9, 0)]);
+        $completion = $operation->operateHedged($object);
+        $this->assertEquals("test-data", $completion->getResult()[0]->getResult());
+        $ioContext->setLatencyPolicy(null);
+    }
+}
@@ -0,0 +1,93 @@
+<?php
+
+namespace Tests\Integration;
+
+use Aternos\Rados\Store\Log\Log;
+use Aternos\Rados\Store\Log\LogPosition;
+use Aternos\Rados\Store\Log\LogRecord;
+use Tests\RadosTestCase;
+
+class LogTest extends RadosTestCase
+{
+    public function testProduceAndConsume(): void
+    {
+        $log = Log::open($this->getIOContext(), "log-" . uniqid(), 1024);
+        $producer = $log->createProducer(256, 100);
+        for ($i = 0; $i < 200; $i++) {
+            $producer->append("record-" . $i);
+        }
+        $producer->flush();
+        $this->assertEquals(0, $producer->getBufferedRecords());
+        $this->assertGreaterThan(0, $log->getHeadSegment());
+
+        $consumer = $log->createConsumer("test", 64);
+        $records = $consumer->poll(150);
+        $this->assertCount(150, $records);
+        $records = array_merge($records, $consumer->poll(1000));
+        $this->assertEquals(
+            array_map(fn(int $i) => "record-" . $i, range(0, 199)),
+            array_map(fn(LogRecord $record) => $record->getData(), $records)
+        );
+        $this->assertCount(0, $consumer->poll());
+    }
+
+    public function testCommit(): void
+    {
+        $log = Log::open($this->getIOContext(), "log-commit-" . uniqid());
+        $producer = $log->createProducer();
+        $producer->append("a")->append("b")->append("c")->flush();
+
+        $consumer = $log->createConsumer("group");
+        $this->assertEquals("a", $consumer->poll(1)[0]->getData());
+        $consumer->commit();
+
+        $consumer = $log->createConsumer("group");
+        $this->assertEquals(["b", "c"], array_map(fn(LogRecord $record) => $record->getData(), $consumer->poll()));
+
+        $other = $log->createConsumer("other");
+        $this->assertCount(3, $other->poll());
+    }
+
+    public function testSeekWithPendingReadAhead(): void
+    {
+        $log = Log::open($this->getIOContext(), "log-seek-" . uniqid(), 4096);
+        $producer = $log->createProducer();
+        for ($i = 0; $i < 50; $i++) {
+            $producer->append("record-" . $i);
+        }
+        $producer->flush();
+        $expected = array_map(fn(int $i) => "record-" . $i, range(0, 49));
+
+        $consumer = $log->createConsumer("test", 16);
+        $this->assertEquals("record-0", $consumer->poll(1)[0]->getData());
+        $consumer->seek(new LogPosition(0, 0));
+        $records = $consumer->poll(1000);
+        $this->assertEquals($expected, array_map(fn(LogRecord $record) => $record->getData(), $records));
+
+        $consumer->seek(new LogPosition(0, 0));
+        $consumer->poll(5);
+        $consumer->seek($records[20]->getPosition());
+        $this->assertEquals(
+            array_slice($expected, 20),
+            array_map(fn(LogRecord $record) => $record->getData(), $consumer->poll(1000))
+        );
+    }
+
+    public function testConcurrentProducersRespectSegmentSize(): void
+    {
+        $log = Log::open($this->getIOContext(), "log-producers-" . uniqid(), 100);
+        $first = $log->createProducer(1);
+        $second = $log->createProducer(1);
+        for ($i = 0; $i < 30; $i++) {
+            $first->append(str_pad("first-" . $i, 16));
+            $second->append(str_pad("second-" . $i, 16));
+        }
+
+        $head = $log->getHeadSegment();
+        $this->assertGreaterThanOrEqual(11, $head);
+        for ($segment = 0; $segment <= $head; $segment++) {
+            $this->assertLessThanOrEqual(100, $log->getSegmentObject($segment)->stat()->getSize());
+        }
+        $this->assertCount(60, $log->createConsumer("test")->poll(1000));
+    }
+}
@@ -0,0 +1,184 @@
+<?php
+
+namespace Tests\Integration;
+
+use Aternos\Rados\Cluster\Pool\Mirror\MirroredIOContext;
+use Aternos\Rados\Cluster\Pool\Mirror\MirrorMode;
+use Aternos\Rados\Cluster\Pool\Object\RadosObject;
+use Aternos\Rados\Exception\RadosException;
+use Aternos\Rados\Operation\Common\Task\AssertExistsTask;
+use Aternos\Rados\Operation\Read\ReadOperation;
+use Aternos\Rados\Operation\Read\Task\OMapGetTask;
+use Aternos\Rados\Operation\Write\Task\AppendTask;
+use Aternos\Rados\Operation\Write\Task\OMapSetTask;
+use Aternos\Rados\Operation\Write\Task\SetXAttributeTask;
+use Aternos\Rados\Operation\Write\WriteOperation;
+use Tests\RadosTestCase;
+
+class MirrorTest extends RadosTestCase
+{
+    protected function createMirror(MirrorMode $mode): MirroredIOContext
+    {
+        $namespace = "mirror-" . uniqid();
+        return new MirroredIOContext(
+            $this->getPool()->createIOContext()->setNamespace($namespace . "-primary"),
+            $this->getPool()->createIOContext()->setNamespace($namespace . "-secondary"),
+            $mode
+        );
+    }
+
+    public function testDualWrite(): void
+    {
+        $mirror = $this->createMirror(MirrorMode::Both);
+        $object = $mirror->getObject("object");
+        $object->writeFull("new");
+        $this->assertFalse($this->exists($object->getSecondary()));
+        $mirror->flush();
+
+        $object->writeFull("hello");
+        $object->append(" world");
+        $object->write("W", 6);
+        $object->setXAttribute("attr", "value");
+        $object->operate(fn() => [new SetXAttributeTask("op", "1")]);
+
+        foreach ([$object->getPrimary(), $object->getSecondary()] as $target) {
+            $this->assertEquals("hello World", $target->read(100, 0));
+            $this->assertEquals("value", $target->getXAttribute("attr"));
+            $this->assertEquals("1", $target->getXAttribute("op"));
+        }
+        $this->assertEquals(0, $mirror->getRetryQueueSize());
+
+        $object->removeXAttribute("attr");
+        $object->remove();
+        $this->assertFalse($this->exists($object->getPrimary()));
+        $this->assertFalse($this->exists($object->getSecondary()));
+    }
+
+    public function testPrimaryModeResyncsMissingObjects(): void
+    {
+        $mirror = $this->createMirror(MirrorMode::Primary);
+        $completions = [];
+        for ($i = 0; $i < 10; $i++) {
+            $completions[] = $mirror->getObject("new")->appendAsync("-" . $i);
+        }
+        foreach ($completions as $completion) {
+            $completion->waitAndGetResult();
+        }
+
+        $mirror->getPrimary()->getObject("existing")->writeFull("existing data");
+        $mirror->getObject("existing")->operate(fn() => [new AssertExistsTask(), new AppendTask("!")]);
+        $mirror->getObject("existing")->setXAttribute("attr", "value");
+        $mirror->flush();
+
+        foreach (["new", "existing"] as $objectId) {
+            $this->assertEquals(
+                $mirror->getPrimary()->getObject($objectId)->read(1000, 0),
+                $mirror->getSecondary()->getObject($objectId)->read(1000, 0)
+            );
+        }
+        $this->assertEquals("existing data!", $mirror->getSecondary()->getObject("existing")->read(1000, 0));
+        $this->assertEquals("value", $mirror->getSecondary()->getObject("existing")->getXAttribute("attr"));
+        $this->assertEquals(0, $mirror->getRetryQueueSize());
+        $this->assertCount(0, $mirror->getFailedObjects());
+    }
+
+    public function testPartialWritesDoNotCreatePartialSecondaryObjects(): void
+    {
+        $mirror = $this->createMirror(MirrorMode::Both);
+        $mirror->getPrimary()->getObject("object")->writeFull("existing data");
+        $mirror->getPrimary()->getObject("object")->setXAttribute("existing", "1");
+
+        $object = $mirror->getObject("object");
+        $object->append("!");
+        $object->write("E", 0);
+        $object->setXAttribute("attr", "value");
+        $this->assertFalse($this->exists($object->getSecondary()));
+        $this->assertEquals(1, $mirror->getRetryQueueSize());
+
+        $mirror->flush();
+        $this->assertEquals("Existing data!", $object->getSecondary()->read(1000, 0));
+        $this->assertEquals("1", $object->getSecondary()->getXAttribute("existing"));
+        $this->assertEquals("value", $object->getSecondary()->getXAttribute("attr"));
+        $this->assertCount(0, $mirror->getFailedObjects());
+    }
+
+    public function testWriteFullDoesNotCreatePartialSecondaryObjects(): void
+    {
+        $mirror = $this->createMirror(MirrorMode::Both);
+        $primary = $mirror->getPrimary()->getObject("object");
+        $primary->writeFull("old data");
+        $primary->setXAttribute("attr", "value");
+        WriteOperation::create($mirror->getPrimary()->getFFI())
+            ->addTask(new OMapSetTask(["key" => "value"]))
+            ->operate($primary);
+
+        $object = $mirror->getObject("object");
+        $object->writeFull("new data");
+        $this->assertFalse($this->exists($object->getSecondary()));
+        $this->assertEquals(1, $mirror->getRetryQueueSize());
+
+        $mirror->flush();
+        $this->assertEquals("new data", $object->getSecondary()->read(1000, 0));
+        $this->assertEquals("value", $object->getSecondary()->getXAttribute("attr"));
+        $this->assertEquals(["key" => "value"], $this->getOMap($object->getSecondary()));
+        $this->assertCount(0, $mirror->getFailedObjects());
+    }
+
+    public function testRemoveObjectMissingOnSecondary(): void
+    {
+        $mirror = $this->createMirror(MirrorMode::Both);
+        $mirror->getPrimary()->getObject("object")->writeFull("data");
+
+        $mirror->getObject("object")->remove();
+        $this->assertFalse($this->exists($mirror->getPrimary()->getObject("object")));
+        $this->assertEquals(0, $mirror->getRetryQueueSize());
+        $mirror->flush();
+        $this->assertFalse($this->exists($mirror->getSecondary()->getObject("object")));
+    }
+
+    public function testBackfill(): void
+    {
+        $mirror = $this->createMirror(MirrorMode::Both);
+        $primary = $mirror->getPrimary();
+        $data = random_bytes(20000);
+        for ($i = 0; $i < 20; $i++) {
+            $primary->getObject("object-" . $i)->writeFull($data . $i);
+        }
+        $primary->getObject("object-0")->setXAttribute("attr", "value");
+        WriteOperation::create($primary->getFFI())
+            ->addTask(new OMapSetTask(["a" => "1", "b" => "2"]))
+            ->operate($primary->getObject("object-1"));
+
+        $backfill = $mirror->createBackfill(4, 4096);
+        $this->assertEquals(5, $backfill->run(5));
+        $this->assertFalse($backfill->isFinished());
+        $this->assertEquals(15, $backfill->run());
+        $this->assertTrue($backfill->isFinished());
+        $this->assertEquals(20, $backfill->getCopiedCount());
+
+        $secondary = $mirror->getSecondary();
+        for ($i = 0; $i < 20; $i++) {
+            $this->assertEquals($data . $i, $secondary->getObject("object-" . $i)->read(30000, 0));
+        }
+        $this->assertEquals("value", $secondary->getObject("object-0")->getXAttribute("attr"));
+        $this->assertEquals(["a" => "1", "b" => "2"], $this->getOMap($secondary->getObject("object-1")));
+        $this->assertEquals([], $this->getOMap($secondary->getObject("object-2")));
+    }
+
+    protected function getOMap(RadosObject $object): array
+    {
+        $task = new OMapGetTask(100);
+        ReadOperation::create($object->getIOContext()->getFFI())->addTask($task)->operate($object);
+        return iterator_to_array($task->getResult()->getIterator());
+    }
+
+    protected function exists(RadosObject $object): bool
+    {
+        try {
+            $object->stat();
+            return true;
+        } catch (RadosException) {
+            return false;
+        }
+    }
+}
@@ -137,4 +137,72 @@ class ObjectTest extends RadosTestCase
         $this->assertGreaterThan(time() - 10, $stat->getModifiedTime()->getSeconds());
         $this->assertLessThanOrEqual(time(), $stat->getModifiedTime()->getSeconds());
     }
+
+    public function testWriteBufferView(): void
+    {
+        $ioContext = $this->getIOContext();
+        $object = $ioContext->getObject("test-buffer-view");
+        $buffer = $this->getRados()->createBuffer(16)->write("0123456789abcdef");
+
+        $object->writeFull($buffer->view(0, 4));
+        $this->assertEquals("0123", $object->read(100, 0));
+        $object->write($buffer->view(10, 2), 2);
+        $this->assertEquals("01ab", $object->read(100, 0));
+        $object->append($buffer->view(4)->slice(0, 3));
+        $this->assertEquals("01ab456", $object->read(100, 0));
+        $object->appendAsync($buffer->view(15))->waitAndGetResult();
+        $this->assertEquals("01ab456f", $object->read(100, 0));
+        $object->writeFullAsync($buffer)->waitAndGetResult();
+        $this->assertEquals("0123456789abcdef", $object->read(100, 0));
+        $this->assertEquals("89ab", $buffer->view(8, 4)->toString());
+    }
+
+    public function testCopyTo(): void
+    {
+        $ioContext = $this->getIOContext();
+        $data = random_bytes(100000);
+        $source = $ioContext->getObject("test-copy-source");
+        $source->writeFull($data);
+        $target = $ioContext->getObject("test-copy-target");
+        $target->writeFull(str_repeat("x", 200000));
+
+        $source->copyTo($target, 4096, 3);
+        $this->assertEquals(100000, $target->stat()->getSize());
+        $this->assertEquals($data, $target->read(200000, 0));
+
+        $empty = $ioContext->getObject("test-copy-empty");
+        $empty->writeFull("");
+        $empty->copyTo($target);
+        $this->assertEquals(0, $target->stat()->getSize());
+    }
+
+    public function testUploadAndDownloadFile(): void
+    {
+        $object = $this->getIOContext()->getObject("test-file-transfer");
+        $data = random_bytes(100000);
+        $source = tempnam(sys_get_temp_dir(), "rados-upload");
+        $target = tempnam(sys_get_temp_dir(), "rados-download");
+        file_put_contents($source, $data);
+        file_put_contents($target, str_repeat("x", 200000));
+
+        try {
+            $object->writeFull(str_repeat("y", 200000));
+            $object->uploadFile($source, 4096, 3);
+            $this->assertEquals($data, $object->read(200000, 0));
+
+            $object->downloadFile($target, 4096, 3);
+            clearstatcache();
+            $this->assertEquals($data, file_get_contents($target));
+
+            file_put_contents($source, "");
+            $object->uploadFile($source);
+            $this->assertEquals(0, $object->stat()->getSize());
+            $object->downloadFile($target);
+            clearstatcache();
+            $this->assertEquals(0, filesize($target));
+        } finally {
+            unlink($source);
+            unlink($target);
+        }
+    }
 }
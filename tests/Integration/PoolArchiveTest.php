@@ -0,0 +1,94 @@
+<?php
+
+namespace Tests\Integration;
+
+use Aternos\Rados\Cluster\Pool\Archive\ArchiveReader;
+use Aternos\Rados\Cluster\Pool\Archive\ArchiveRecordType;
+use Aternos\Rados\Cluster\Pool\Archive\PoolExporter;
+use Aternos\Rados\Cluster\Pool\Archive\PoolImporter;
+use Aternos\Rados\Exception\ArchiveException;
+use Aternos\Rados\Operation\Read\ReadOperation;
+use Aternos\Rados\Operation\Read\Task\OMapGetTask;
+use Aternos\Rados\Operation\Write\Task\OMapSetTask;
+use Aternos\Rados\Operation\Write\WriteOperation;
+use Tests\RadosTestCase;
+
+class PoolArchiveTest extends RadosTestCase
+{
+    public function testExportAndImport(): void
+    {
+        $ioContext = $this->getIOContext();
+        $large = random_bytes(10000);
+        $ioContext->getObject("large")->writeFull($large);
+        $ioContext->getObject("empty")->writeFull("");
+        $attributes = $ioContext->getObject("attributes");
+        $attributes->writeFull("data");
+        $attributes->setXAttribute("a", "1");
+        $attributes->setXAttribute("b", "2");
+        $omap = [];
+        for ($i = 0; $i < 50; $i++) {
+            $omap["key-" . $i] = "value-" . $i;
+        }
+        WriteOperation::create($ioContext->getFFI())
+            ->addTask(new OMapSetTask($omap))
+            ->operate($ioContext->getObject("omap"));
+
+        $stream = fopen("php://memory", "w+");
+        $exporter = new PoolExporter($ioContext, 2, 4096, 16);
+        $this->assertEquals(4, $exporter->export($stream));
+
+        $target = $this->getPool()->createIOContext()->setNamespace("restore");
+        $target->getObject("large")->writeFull("old data that is longer than nothing");
+        rewind($stream);
+        $importer = new PoolImporter($target, 4, 4096);
+        $this->assertEquals(4, $importer->import($stream));
+
+        $this->assertEquals($large, $target->getObject("large")->read(20000, 0));
+        $this->assertEquals(0, $target->getObject("empty")->stat()->getSize());
+        $this->assertEquals("data", $target->getObject("attributes")->read(100, 0));
+        $this->assertEquals("1", $target->getObject("attributes")->getXAttribute("a"));
+        $this->assertEquals("2", $target->getObject("attributes")->getXAttribute("b"));
+
+        $task = new OMapGetTask(100);
+        ReadOperation::create($target->getFFI())->addTask($task)->operate($target->getObject("omap"));
+        $this->assertEquals($omap, iterator_to_array($task->getResult()->getIterator()));
+    }
+
+    public function testExportReadsSnapshot(): void
+    {
+        $ioContext = $this->getPool()->createIOContext()->setNamespace("snapshot");
+        $object = $ioContext->getObject("object");
+        $object->writeFull("before");
+        $snapshot = $ioContext->createSnapshot("archive-test-" . uniqid());
+        $object->writeFull("after");
+        $ioContext->getObject("new")->writeFull("new");
+
+        $stream = fopen("php://memory", "w+");
+        $this->assertEquals(1, (new PoolExporter($ioContext))->export($stream, $snapshot));
+        $snapshot->remove();
+
+        rewind($stream);
+        $reader = new ArchiveReader($stream);
+        $records = [];
+        do {
+            $record = $reader->readRecord();
+            $records[] = $record;
+        } while ($record->getType() !== ArchiveRecordType::Finish);
+
+        $this->assertEquals("object", $records[0]->getName());
+        $data = array_values(array_filter($records, fn($record) => $record->getType() === ArchiveRecordType::Data));
+        $this->assertCount(1, $data);
+        $this->assertEquals("before", $data[0]->getValue());
+        $this->assertEquals("after", $object->read(100, 0));
+    }
+
+    public function testInvalidArchive(): void
+    {
+        $stream = fopen("php://memory", "w+");
+        fwrite($stream, "not an archive");
+        rewind($stream);
+
+        $this->expectException(ArchiveException::class);
+        (new PoolImporter($this->getIOContext()))->import($stream);
+    }
+}
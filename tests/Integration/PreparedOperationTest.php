@@ -0,0 +1,123 @@
+<?php
+
+namespace Tests\Integration;
+
+use Aternos\Rados\Operation\Read\Task\GetXAttributesTask;
+use Aternos\Rados\Operation\Read\Task\OMapGetByKeysTask;
+use Aternos\Rados\Operation\Read\Task\OMapGetTask;
+use Aternos\Rados\Operation\Read\Task\ReadTask;
+use Aternos\Rados\Operation\Read\Task\StatTask;
+use Aternos\Rados\Operation\Write\Task\OMapSetTask;
+use Aternos\Rados\Operation\Write\Task\SetXAttributeTask;
+use Aternos\Rados\Operation\Write\Task\WriteFullTask;
+use Aternos\Rados\Operation\Write\WriteOperation;
+use Tests\RadosTestCase;
+
+class PreparedOperationTest extends RadosTestCase
+{
+    public function testPreparedWriteAndRead(): void
+    {
+        $ioContext = $this->getIOContext();
+        $prefix = "prepared-op-" . uniqid() . "-";
+
+        $write = $this->getRados()->createPreparedWriteOperation(fn() => [
+            new WriteFullTask("header"),
+            new OMapSetTask(["key1" => "value1", "key2" => "value2"])
+        ]);
+        $read = $this->getRados()->createPreparedReadOperation(fn() => [
+            new ReadTask(6, 0),
+            new OMapGetByKeysTask(["key1", "key2"]),
+            new StatTask()
+        ]);
+
+        for ($i = 0; $i < 3; $i++) {
+            $write->operate($ioContext->getObject($prefix . $i));
+        }
+        $this->assertEquals(1, $write->getSlotCount());
+
+        for ($i = 0; $i < 3; $i++) {
+            [$readTask, $omapTask, $statTask] = $read->operate($ioContext->getObject($prefix . $i));
+            $this->assertEquals("header", $readTask->getResult());
+            $this->assertEquals(["key1" => "value1", "key2" => "value2"], iterator_to_array($omapTask->getResult()->getIterator()));
+            $this->assertEquals(6, $statTask->getResult()->getSize());
+        }
+        $this->assertEquals(1, $read->getSlotCount());
+    }
+
+    public function testPreparedOperationPipelined(): void
+    {
+        $ioContext = $this->getIOContext();
+        $prefix = "prepared-pipeline-" . uniqid() . "-";
+
+        $objects = [];
+        for ($i = 0; $i < 10; $i++) {
+            $objects[] = $object = $ioContext->getObject($prefix . $i);
+            $object->writeFull("data-" . $i);
+        }
+
+        $read = $this->getRados()->createPreparedReadOperation(fn() => [new ReadTask(6, 0)]);
+        $results = [];
+        foreach ($read->operatePipelined($objects, 4) as $object => $completion) {
+            $results[$object->getId()] = $completion->getResult()[0]->getResult();
+        }
+
+        $this->assertCount(10, $results);
+        for ($i = 0; $i < 10; $i++) {
+            $this->assertEquals("data-" . $i, $results[$prefix . $i]);
+        }
+        $this->assertLessThanOrEqual(5, $read->getSlotCount());
+    }
+
+    public function testDroppedCompletionsKeepTheirSlot(): void
+    {
+        $ioContext = $this->getIOContext();
+        $prefix = "prepared-dropped-" . uniqid() . "-";
+        for ($i = 0; $i < 5; $i++) {
+            $ioContext->getObject($prefix . $i)->writeFull("data-" . $i);
+        }
+
+        $read = $this->getRados()->createPreparedReadOperation(fn() => [new ReadTask(6, 0)]);
+        for ($i = 0; $i < 4; $i++) {
+            $read->operateAsync($ioContext->getObject($prefix . $i));
+        }
+        $completion = $read->operateAsync($ioContext->getObject($prefix . 4));
+        $this->assertEquals("data-4", $completion->waitAndGetResult()[0]->getResult());
+        $this->assertLessThanOrEqual(5, $read->getSlotCount());
+
+        $read->recycle($completion);
+        $completion = $read->operateAsync($ioContext->getObject($prefix . 0));
+        $this->assertEquals("data-0", $completion->waitAndGetResult()[0]->getResult());
+    }
+
+    public function testIteratorResultsSurviveNextExecution(): void
+    {
+        $ioContext = $this->getIOContext();
+        $prefix = "prepared-iterator-" . uniqid() . "-";
+        for ($i = 0; $i < 2; $i++) {
+            WriteOperation::create($ioContext->getFFI())
+                ->addTask(new SetXAttributeTask("attr", "value-" . $i))
+                ->addTask(new OMapSetTask(["key" => "value-" . $i]))
+                ->operate($ioContext->getObject($prefix . $i));
+        }
+
+        $read = $this->getRados()->createPreparedReadOperation(fn() => [
+            new OMapGetTask(10),
+            new GetXAttributesTask()
+        ]);
+
+        [$omapTask, $xAttributesTask] = $read->operate($ioContext->getObject($prefix . 0));
+        $firstOMap = $omapTask->getResult()->getIterator();
+        $firstXAttributes = $xAttributesTask->getResult();
+
+        [$omapTask, $xAttributesTask] = $read->operate($ioContext->getObject($prefix . 1));
+        $secondOMap = $omapTask->getResult()->getIterator();
+        $secondXAttributes = $xAttributesTask->getResult();
+
+        $this->assertEquals(["key" => "value-0"], iterator_to_array($firstOMap));
+        $this->assertEquals(["attr" => "value-0"], iterator_to_array($firstXAttributes));
+        unset($firstOMap, $firstXAttributes);
+
+        $this->assertEquals(["key" => "value-1"], iterator_to_array($secondOMap));
+        $this->assertEquals(["attr" => "value-1"], iterator_to_array($secondXAttributes));
+    }
+}
@@ -0,0 +1,107 @@
+<?php
+
+namespace Tests\Integration;
+
+use Aternos\Rados\Store\KeyValue\ShardedKeyValueStore;
+use Tests\RadosTestCase;
+
+class ShardedKeyValueStoreTest extends RadosTestCase
+{
+    /**
+     * @return array<string, string>
+     */
+    protected function createValues(int $count): array
+    {
+        $values = [];
+        for ($i = 0; $i < $count; $i++) {
+            $values["key-" . str_pad($i, 4, "0", STR_PAD_LEFT)] = "value-" . $i;
+        }
+        return $values;
+    }
+
+    public function testGetSetDelete(): void
+    {
+        $store = ShardedKeyValueStore::open($this->getIOContext(), "kv-" . uniqid(), 4);
+        $this->assertEquals(4, $store->getShardCount());
+
+        $values = $this->createValues(100);
+        $store->setMany($values);
+        $this->assertEquals($values, $store->getMany(array_keys($values)));
+        $this->assertEquals("value-5", $store->get("key-0005"));
+        $this->assertNull($store->get("missing"));
+
+        $store->deleteMany(["key-0001", "key-0002"]);
+        $this->assertEquals(["key-0003" => "value-3"], $store->getMany(["key-0001", "key-0002", "key-0003"]));
+    }
+
+    public function testScan(): void
+    {
+        $store = ShardedKeyValueStore::open($this->getIOContext(), "kv-scan-" . uniqid(), 8);
+        $values = $this->createValues(250);
+        $store->setMany($values);
+
+        $this->assertSame($values, iterator_to_array($store->scan(batchSize: 16)));
+        $this->assertSame(
+            array_slice($values, 11, 9),
+            iterator_to_array($store->scan("key-0010", "key-001", 4))
+        );
+    }
+
+    public function testReshard(): void
+    {
+        $name = "kv-reshard-" . uniqid();
+        $store = ShardedKeyValueStore::open($this->getIOContext(), $name, 2);
+        $values = $this->createValues(200);
+        $store->setMany($values);
+
+        $store->reshard(5, 32);
+        $this->assertEquals(5, $store->getShardCount());
+        $this->assertNull($store->getReshardTarget());
+        $this->assertEquals($values, $store->getMany(array_keys($values)));
+        $this->assertSame($values, iterator_to_array($store->scan()));
+
+        $store->reshard(3, 32);
+        $reopened = ShardedKeyValueStore::open($this->getIOContext(), $name);
+        $this->assertEquals(3, $reopened->getShardCount());
+        $this->assertSame($values, iterator_to_array($reopened->scan()));
+    }
+
+    public function testStaleInstanceAfterReshard(): void
+    {
+        $name = "kv-stale-" . uniqid();
+        $stale = ShardedKeyValueStore::open($this->getIOContext(), $name, 2);
+        $values = $this->createValues(50);
+        $stale->setMany($values);
+
+        $resharder = ShardedKeyValueStore::open($this->getIOContext(), $name);
+        $resharder->reshard(7, 16);
+        $this->assertEquals(2, $stale->getShardCount());
+
+        $newValues = $this->createValues(100);
+        $stale->setMany($newValues);
+        $this->assertEquals(7, $stale->getShardCount());
+        $this->assertEquals($resharder->getEpoch(), $stale->getEpoch());
+
+        $stale->delete("key-0003");
+        unset($newValues["key-0003"]);
+        $resharder->refresh();
+        $this->assertEquals($newValues, $resharder->getMany(array_keys($this->createValues(100))));
+        $this->assertSame($newValues, iterator_to_array($resharder->scan()));
+    }
+
+    public function testStaleInstanceAfterMultipleReshards(): void
+    {
+        $name = "kv-stale-reshard-" . uniqid();
+        $store = ShardedKeyValueStore::open($this->getIOContext(), $name, 3);
+        $store->setMany($this->createValues(20));
+
+        $stale = ShardedKeyValueStore::open($this->getIOContext(), $name);
+        $store->reshard(6, 4);
+        $store->reshard(2, 4);
+
+        $stale->set("key-0001", "changed");
+        $this->assertEquals(2, $stale->getShardCount());
+        $this->assertEquals("changed", $store->get("key-0001"));
+        $this->assertEquals("value-2", $stale->get("key-0002"));
+    }
+}
@@ -0,0 +1,82 @@
+<?php
+
+namespace Tests\Integration;
+
+use Aternos\Rados\Cluster\Pool\Throttle\Throttle;
+use Aternos\Rados\Cluster\Pool\Throttle\ThrottlePriority;
+use Tests\RadosTestCase;
+
+class ThrottleTest extends RadosTestCase
+{
+    public function testOperationRateLimit(): void
+    {
+        $ioContext = $this->getIOContext();
+        $throttle = new Throttle(20, null, null, 1);
+        $ioContext->setThrottle($throttle, ThrottlePriority::High);
+
+        $start = microtime(true);
+        $completions = [];
+        for ($i = 0; $i < 5; $i++) {
+            $completions[] = $ioContext->getObject("throttle-" . uniqid())->writeFullAsync("test");
+        }
+        foreach ($completions as $completion) {
+            $completion->waitAndGetResult();
+        }
+
+        $this->assertGreaterThanOrEqual(0.19, microtime(true) - $start);
+        $this->assertEquals(4, $throttle->getThrottledCount(ThrottlePriority::High));
+        $this->assertLessThanOrEqual(1, $throttle->getOperationTokens());
+        $ioContext->setThrottle(null);
+    }
+
+    public function testInFlightLimit(): void
+    {
+        $ioContext = $this->getIOContext();
+        $throttle = new Throttle(null, 1024 * 1024, 2);
+        $ioContext->setThrottle($throttle);
+
+        $completions = [];
+        for ($i = 0; $i < 10; $i++) {
+            $completions[] = $ioContext->getObject("throttle-inflight-" . uniqid())->writeFullAsync("test");
+            $this->assertLessThanOrEqual(2, $throttle->getInFlightCount());
+        }
+        foreach ($completions as $completion) {
+            $completion->waitAndGetResult();
+        }
+
+        $this->assertEquals(0, $throttle->getInFlightCount());
+        $this->assertEquals(0, $throttle->getWaitingCount());
+        $ioContext->setThrottle(null);
+    }
+
+    public function testFullLimitsWithoutHigherPriority(): void
+    {
+        $ioContext = $this->getIOContext();
+        $throttle = new Throttle(1, null, null, 4);
+        $ioContext->setThrottle($throttle);
+
+        $completions = [];
+        for ($i = 0; $i < 4; $i++) {
+            $completions[] = $ioContext->getObject("throttle-full-" . uniqid())->writeFullAsync("test");
+        }
+        foreach ($completions as $completion) {
+            $completion->waitAndGetResult();
+        }
+
+        $this->assertEquals(0, $throttle->getThrottledCount());
+        $ioContext->setThrottle(null);
+    }
+
+    public function testReleaseReturnsCapacity(): void
+    {
+        $throttle = new Throttle(1, 100, 1, 1, 100);
+        $throttle->acquire(100, ThrottlePriority::Low);
+        $this->assertEquals(1, $throttle->getInFlightCount());
+        $this->assertLessThan(1, $throttle->getByteTokens());
+
+        $throttle->release(100, ThrottlePriority::Low);
+        $this->assertEquals(0, $throttle->getInFlightCount());
+        $this->assertEqualsWithDelta(1, $throttle->getOperationTokens(), 0.001);
+        $this->assertEqualsWithDelta(100, $throttle->getByteTokens(), 0.001);
+    }
+}